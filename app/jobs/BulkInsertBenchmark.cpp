@@ -0,0 +1,100 @@
+#include "Job.hpp"
+
+SOURCE("app/services/mysql/Connection.cpp")
+SOURCE("app/services/mysql/Model.cpp")
+SOURCE("app/services/mysql/Profiler.cpp")
+SOURCE("app/services/mysql/QueryCache.cpp")
+SOURCE("app/services/mysql/Schema.cpp")
+SOURCE("app/services/mysql/Sequence.cpp")
+SOURCE("app/services/mysql/Transaction.cpp")
+SOURCE("app/services/database/Columnar.cpp")
+SOURCE("app/services/database/Cursor.cpp")
+SOURCE("app/services/database/Relation.cpp")
+SOURCE("app/services/database/Table.cpp")
+SOURCE("app/services/serialization/Json.cpp")
+SOURCE("app/services/serialization/Model.cpp")
+SOURCE("app/services/logging/Logstream.cpp")
+LIBRARY("mysqlcppconn8")
+
+#include "../services/mysql/MySQL.hpp"
+
+#include <chrono>
+#include <iostream>
+
+// Compares inserting, updating and upserting models one statement at a time against the batched table
+// operations, at 1k, 10k and 100k rows. Needs a MySQL server configured through mysql::connection, and
+// creates and drops a benchmark_rows table in its database.
+
+struct benchmark_row : mysql::model {
+    property<std::string> name  { this, "name"  };
+    property<long long>   value { this, "value" };
+
+    std::string table_name() const { return "benchmark_rows"; }
+
+    void define_schema(db::schema& s) const {
+        s.column("name", "varchar(64)");
+    }
+};
+
+template<class F>
+static double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+
+    f();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::vector<std::shared_ptr<db::model>> make_rows(size_t count) {
+    std::vector<std::shared_ptr<db::model>> rows;
+
+    for (size_t i = 0; i < count; i++) {
+        auto row = std::make_shared<benchmark_row>();
+
+        row->name  = "row " + std::to_string(i);
+        row->value = (long long)i;
+
+        rows.push_back(row);
+    }
+
+    return rows;
+}
+
+static void touch(std::vector<std::shared_ptr<db::model>>& rows) {
+    for (auto& row : rows) {
+        std::static_pointer_cast<benchmark_row>(row)->value += 1;
+    }
+}
+
+int main() {
+    mysql::table<benchmark_row> table;
+
+    for (size_t count : { 1000, 10000, 100000 }) {
+        table.destroy();
+        table.create();
+
+        auto single  = make_rows(count);
+        auto batched = make_rows(count);
+
+        double insert_single  = time_ms([&] { for (auto& row : single) std::static_pointer_cast<benchmark_row>(row)->save(); });
+        double insert_batched = time_ms([&] { table.insert(batched); });
+
+        touch(single);
+        touch(batched);
+
+        double update_single  = time_ms([&] { for (auto& row : single) std::static_pointer_cast<benchmark_row>(row)->save(); });
+        double update_batched = time_ms([&] { table.update(batched); });
+
+        touch(batched);
+
+        double upsert_batched = time_ms([&] { table.upsert(batched); });
+
+        std::cout << std::format("{} rows: insert {:.0f} ms one by one, {:.0f} ms batched; "
+                                 "update {:.0f} ms one by one, {:.0f} ms batched; upsert {:.0f} ms batched\n",
+                                 count, insert_single, insert_batched, update_single, update_batched, upsert_batched);
+    }
+
+    table.destroy();
+
+    return 0;
+}
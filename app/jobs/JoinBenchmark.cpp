@@ -0,0 +1,115 @@
+#include "Job.hpp"
+
+SOURCE("app/services/mysql/Connection.cpp")
+SOURCE("app/services/mysql/Model.cpp")
+SOURCE("app/services/mysql/Profiler.cpp")
+SOURCE("app/services/mysql/QueryCache.cpp")
+SOURCE("app/services/mysql/Schema.cpp")
+SOURCE("app/services/mysql/Sequence.cpp")
+SOURCE("app/services/mysql/Transaction.cpp")
+SOURCE("app/services/database/Columnar.cpp")
+SOURCE("app/services/database/Cursor.cpp")
+SOURCE("app/services/database/Relation.cpp")
+SOURCE("app/services/database/Table.cpp")
+SOURCE("app/services/serialization/Json.cpp")
+SOURCE("app/services/serialization/Model.cpp")
+SOURCE("app/services/logging/Logstream.cpp")
+LIBRARY("mysqlcppconn8")
+
+#include "../services/mysql/MySQL.hpp"
+
+#include <chrono>
+#include <iostream>
+
+// Compares fetching authors with their posts through a single joined query against the N+1 pattern of
+// one query per author, at 100, 1k and 10k authors with 5 posts each. Needs a MySQL server configured
+// through mysql::connection, and creates and drops the benchmark_authors and benchmark_posts tables.
+
+struct benchmark_author : mysql::model {
+    property<std::string> name { this, "name" };
+
+    std::string table_name() const { return "benchmark_authors"; }
+
+    void define_schema(db::schema& s) const {
+        s.column("name", "varchar(64)");
+    }
+};
+
+struct benchmark_post : mysql::model {
+    property<long long>   author_id { this, "author_id" };
+    property<std::string> title     { this, "title"     };
+
+    std::string table_name() const { return "benchmark_posts"; }
+
+    void define_schema(db::schema& s) const {
+        s.column("title", "varchar(64)").index({ "author_id" });
+    }
+};
+
+template<class F>
+static double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+
+    f();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    mysql::table<benchmark_author> authors;
+    mysql::table<benchmark_post>   posts;
+
+    for (size_t count : { 100, 1000, 10000 }) {
+        authors.destroy();
+        posts.destroy();
+        authors.create();
+        posts.create();
+
+        std::vector<std::shared_ptr<db::model>> new_authors;
+        std::vector<std::shared_ptr<db::model>> new_posts;
+
+        for (size_t i = 0; i < count; i++) {
+            auto author = std::make_shared<benchmark_author>();
+
+            author->name = "author " + std::to_string(i);
+
+            new_authors.push_back(author);
+        }
+
+        authors.insert(new_authors);
+
+        for (auto& author : new_authors) {
+            for (size_t i = 0; i < 5; i++) {
+                auto post = std::make_shared<benchmark_post>();
+
+                post->author_id = (long long)author->id;
+                post->title     = "post " + std::to_string(i);
+
+                new_posts.push_back(post);
+            }
+        }
+
+        posts.insert(new_posts);
+
+        size_t n_plus_one_rows = 0;
+        size_t joined_rows     = 0;
+
+        double n_plus_one = time_ms([&] {
+            for (auto& author : mysql::table<benchmark_author>().all()) {
+                n_plus_one_rows += mysql::table<benchmark_post>().where("author_id", (long long)author->id, "=").get().size();
+            }
+        });
+
+        double joined = time_ms([&] {
+            joined_rows = authors.inner_join(posts, "id", "author_id")->where("benchmark_authors.id", 0, ">").get().size();
+        });
+
+        std::cout << std::format("{} authors: N+1 {:.0f} ms ({} rows), join {:.0f} ms ({} rows)\n",
+                                 count, n_plus_one, n_plus_one_rows, joined, joined_rows);
+    }
+
+    authors.destroy();
+    posts.destroy();
+
+    return 0;
+}
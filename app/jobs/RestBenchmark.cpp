@@ -0,0 +1,75 @@
+#include "Job.hpp"
+
+SOURCE("app/services/rest/Handle.cpp")
+SOURCE("app/services/rest/Resilience.cpp")
+SOURCE("app/services/rest/Rest.cpp")
+SOURCE("app/services/rest/Source.cpp")
+SOURCE("app/services/serialization/Json.cpp")
+SOURCE("app/services/serialization/Model.cpp")
+LIBRARY("curl")
+LIBRARY("z")
+
+#include "../services/rest/Rest.hpp"
+
+#include <chrono>
+#include <iostream>
+
+// Compares sequential GETs through the pooled handles of rest::get against a fresh curl_easy_init handle per
+// request, which has to connect again every time, at 100, 1k and 10k requests. Takes the url to request, a
+// local stand-in server such as `python3 -m http.server` by default.
+
+static size_t discard(char*, size_t size, size_t nmemb, void*) {
+    return size * nmemb;
+}
+
+static void fresh_get(const std::string& url) {
+    CURL* curl = curl_easy_init();
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard);
+
+    CURLcode ec = curl_easy_perform(curl);
+
+    curl_easy_cleanup(curl);
+
+    if (ec != CURLE_OK) {
+        throw rest::rest_error(std::string("Failed to send GET request: ") + curl_easy_strerror(ec), url);
+    }
+}
+
+template<class F>
+static double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+
+    f();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    std::string url = argc > 1 ? argv[1] : "http://127.0.0.1:8000/";
+
+    // Retries would hide failures of either side.
+    rest::retry_policy::defaults.attempts = 1;
+
+    for (size_t count : { 100, 1000, 10000 }) {
+        rest::handle::clear();
+
+        double fresh = time_ms([&] {
+            for (size_t i = 0; i < count; i++) {
+                fresh_get(url);
+            }
+        });
+
+        double pooled = time_ms([&] {
+            for (size_t i = 0; i < count; i++) {
+                rest::get(url);
+            }
+        });
+
+        std::cout << std::format("{} requests: curl_easy_init per call {:.0f} ms, pooled handles {:.0f} ms\n",
+                                 count, fresh, pooled);
+    }
+
+    return 0;
+}
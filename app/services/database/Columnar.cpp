@@ -0,0 +1,311 @@
+#include "Columnar.hpp"
+#include "../tools/Format.hpp"
+
+#include <bit>
+#include <limits>
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
+
+namespace db {
+    static std::string escape_json(const std::string& value) {
+        std::string escaped = "\"";
+
+        for (char c : value) {
+            switch (c) {
+                case '"':  escaped += "\\\""; break;
+                case '\\': escaped += "\\\\"; break;
+                case '\n': escaped += "\\n";  break;
+                case '\r': escaped += "\\r";  break;
+                case '\t': escaped += "\\t";  break;
+                default:
+                    if ((unsigned char)c < 0x20) {
+                        escaped += "\\u00";
+                        escaped += "0123456789abcdef"[(unsigned char)c >> 4];
+                        escaped += "0123456789abcdef"[(unsigned char)c & 0xF];
+                    } else {
+                        escaped += c;
+                    }
+            }
+        }
+
+        return escaped + "\"";
+    }
+
+    static std::string format_double(double value) {
+        char buffer[32];
+
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+        return std::string(buffer, result.ptr);
+    }
+
+    // Minimum or maximum over the non-null rows. Null rows are replaced by the identity instead of being
+    // branched over, which keeps the loop vectorizable.
+    template<typename T, typename Select>
+    static std::optional<double> reduce(std::span<const T> values, const column& c, T identity, Select select) {
+        if (c.size() == c.null_count()) {
+            return std::nullopt;
+        }
+
+        T result = identity;
+
+        if (c.null_count() == 0) {
+            for (auto value : values) {
+                result = select(result, value);
+            }
+        } else {
+            for (size_t i = 0; i < values.size(); i++) {
+                result = select(result, c.is_null(i) ? identity : values[i]);
+            }
+        }
+
+        return (double)result;
+    }
+
+    void column::set_type(type_t new_type) {
+        if (type == integer && new_type == floating_point) {
+            doubles.assign(integers.begin(), integers.end());
+            integers.clear();
+        } else if (type == unknown) {
+            switch (new_type) {
+                case integer:
+                case boolean:        integers.resize(count); break;
+                case floating_point: doubles .resize(count); break;
+                case string:         strings .resize(count); break;
+                default:                                     break;
+            }
+        }
+
+        type = new_type;
+    }
+
+    void column::push(const serialized& value) {
+        if (count % 64 == 0) {
+            null_bits.push_back(0);
+        }
+
+        type_t value_type = unknown;
+
+        switch (value.type) {
+            case serialized::null:           value_type = unknown;        break;
+            case serialized::integer:        value_type = integer;        break;
+            case serialized::floating_point: value_type = floating_point; break;
+            case serialized::boolean:        value_type = boolean;        break;
+            case serialized::string:         value_type = string;         break;
+            default:
+                throw std::runtime_error(::format("Cannot add a value to column \"{}\": models can't be stored in a column.", name));
+        }
+
+        if (value_type == unknown) {
+            null_bits.back() |= (uint64_t)1 << (count % 64);
+        } else if (type == unknown || (type == integer && value_type == floating_point) || (type == boolean && value_type == integer)) {
+            set_type(value_type);
+        } else if (type != value_type && !(type == floating_point && value_type == integer) && !(type == integer && value_type == boolean)) {
+            throw std::runtime_error(::format("Cannot add a value to column \"{}\": the column holds values of another type.", name));
+        }
+
+        switch (type) {
+            case unknown: break;
+            case integer:
+            case boolean:
+                integers.push_back(value_type == integer ? std::get<long long>(value.value) :
+                                   value_type == boolean ? std::get<bool>     (value.value) : 0);
+                break;
+            case floating_point:
+                doubles.push_back(value_type == floating_point ? (double)std::get<long double>(value.value) :
+                                  value_type == integer        ? (double)std::get<long long>  (value.value) : 0);
+                break;
+            case string:
+                strings.push_back(value_type == string ? std::get<std::string>(value.value) : "");
+                break;
+        }
+
+        count++;
+    }
+
+    size_t column::null_count() const {
+        size_t nulls = 0;
+
+        for (auto bits : null_bits) {
+            nulls += std::popcount(bits);
+        }
+
+        return nulls;
+    }
+
+    double column::number(size_t row) const {
+        switch (type) {
+            case integer:
+            case boolean:        return (double)integers[row];
+            case floating_point: return doubles[row];
+            case unknown:        return 0;
+            default:
+                throw std::runtime_error(::format("Cannot read a number from column \"{}\": it holds strings.", name));
+        }
+    }
+
+    std::string column::json(size_t row) const {
+        if (is_null(row)) {
+            return "null";
+        }
+
+        switch (type) {
+            case integer:        return std::to_string(integers[row]);
+            case boolean:        return integers[row] ? "true" : "false";
+            case floating_point: return format_double(doubles[row]);
+            case string:         return escape_json(strings[row]);
+            default:             return "null";
+        }
+    }
+
+    double column::sum() const {
+        switch (type) {
+            case integer:
+            case boolean: {
+                long long total = 0;
+
+                for (auto value : integers) {
+                    total += value;
+                }
+
+                return (double)total;
+            }
+            case floating_point: {
+                // Independent partial sums, floating point additions can't be reordered by the compiler.
+                double partial[4] = { 0, 0, 0, 0 };
+                size_t i          = 0;
+
+                for (; i + 4 <= doubles.size(); i += 4) {
+                    partial[0] += doubles[i];
+                    partial[1] += doubles[i + 1];
+                    partial[2] += doubles[i + 2];
+                    partial[3] += doubles[i + 3];
+                }
+
+                for (; i < doubles.size(); i++) {
+                    partial[0] += doubles[i];
+                }
+
+                return partial[0] + partial[1] + partial[2] + partial[3];
+            }
+            case unknown: return 0;
+            default:
+                throw std::runtime_error(::format("Cannot sum column \"{}\": it holds strings.", name));
+        }
+    }
+
+    std::optional<double> column::min() const {
+        switch (type) {
+            case integer:
+            case boolean:        return reduce(integer_values(), *this, std::numeric_limits<long long>::max(), [](long long a, long long b) { return std::min(a, b); });
+            case floating_point: return reduce(double_values(),  *this, std::numeric_limits<double>   ::infinity(), [](double a, double b) { return std::min(a, b); });
+            case unknown:        return std::nullopt;
+            default:
+                throw std::runtime_error(::format("Cannot find the minimum of column \"{}\": it holds strings.", name));
+        }
+    }
+
+    std::optional<double> column::max() const {
+        switch (type) {
+            case integer:
+            case boolean:        return reduce(integer_values(), *this, std::numeric_limits<long long>::min(), [](long long a, long long b) { return std::max(a, b); });
+            case floating_point: return reduce(double_values(),  *this, -std::numeric_limits<double>  ::infinity(), [](double a, double b) { return std::max(a, b); });
+            case unknown:        return std::nullopt;
+            default:
+                throw std::runtime_error(::format("Cannot find the maximum of column \"{}\": it holds strings.", name));
+        }
+    }
+
+    column_set::column_set(std::vector<std::string> names) {
+        columns.reserve(names.size());
+
+        for (auto& name : names) {
+            columns.emplace_back(name);
+        }
+    }
+
+    void column_set::push_row(std::span<const serialized> values) {
+        if (values.size() != columns.size()) {
+            throw std::runtime_error(::format("Cannot add a row to the result set: expected {} values, got {}.", columns.size(), values.size()));
+        }
+
+        for (size_t i = 0; i < columns.size(); i++) {
+            columns[i].push(values[i]);
+        }
+
+        rows++;
+    }
+
+    const column& column_set::operator[](std::string_view name) const {
+        for (auto& c : columns) {
+            if (c.get_name() == name) {
+                return c;
+            }
+        }
+
+        throw std::out_of_range(::format("Cannot find column \"{}\" in the result set.", std::string(name)));
+    }
+
+    std::map<std::optional<std::string>, column_set::aggregate> column_set::group_by(std::string_view key_column,
+                                                                                    std::string_view value_column) const {
+        auto& keys   = (*this)[key_column];
+        auto& values = (*this)[value_column];
+
+        std::map<std::optional<std::string>, aggregate> groups;
+
+        for (size_t row = 0; row < rows; row++) {
+            std::optional<std::string> key;
+
+            if (!keys.is_null(row)) {
+                key = keys.get_type() == column::string ? keys.string_values()[row] : keys.json(row);
+            }
+
+            auto& group = groups[key];
+
+            if (values.is_null(row)) {
+                continue;
+            }
+
+            double value = values.number(row);
+
+            group.count++;
+            group.sum += value;
+            group.min  = group.min ? std::min(*group.min, value) : value;
+            group.max  = group.max ? std::max(*group.max, value) : value;
+        }
+
+        return groups;
+    }
+
+    std::string column_set::to_json() const {
+        if (rows == 0) {
+            return "[ ]";
+        }
+
+        std::vector<std::string> keys;
+
+        for (auto& c : columns) {
+            keys.push_back(escape_json(c.get_name()) + ": ");
+        }
+
+        std::string json = "[ ";
+
+        for (size_t row = 0; row < rows; row++) {
+            json += row == 0 ? "{ " : ", { ";
+
+            for (size_t i = 0; i < columns.size(); i++) {
+                if (i != 0) {
+                    json += ", ";
+                }
+
+                json += keys[i];
+                json += columns[i].json(row);
+            }
+
+            json += " }";
+        }
+
+        return json + " ]";
+    }
+}
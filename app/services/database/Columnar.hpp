@@ -0,0 +1,109 @@
+#pragma once
+
+#include "../serialization/Serializable.hpp"
+
+#include <map>
+#include <span>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace db {
+    // One column of a column_set, stored as a contiguous typed array plus a null bitmap. Null rows hold 0,
+    // false or "" in the typed array so sums can run over the whole array without checking the bitmap.
+    class column {
+    public:
+        enum type_t {
+            unknown, // only nulls so far
+            integer,
+            floating_point,
+            boolean,
+            string
+        };
+
+    private:
+        std::string name;
+        type_t      type  = unknown;
+        size_t      count = 0;
+
+        std::vector<long long>   integers; // integer and boolean columns
+        std::vector<double>      doubles;
+        std::vector<std::string> strings;
+        std::vector<uint64_t>    null_bits;
+
+        void set_type(type_t new_type);
+
+    public:
+        column(std::string name) : name(name) { }
+
+        // Appends a row. An integer column receiving a floating point value is widened to floating point,
+        // other type mismatches throw.
+        void push(const serialized& value);
+
+        const std::string& get_name() const { return name; }
+        type_t             get_type() const { return type; }
+        size_t             size()     const { return count; }
+
+        bool   is_null(size_t row) const { return (null_bits[row / 64] >> (row % 64)) & 1; }
+        size_t null_count()        const;
+
+        // The typed arrays, only the one matching get_type() holds values.
+        std::span<const long long>   integer_values() const { return integers; }
+        std::span<const double>      double_values()  const { return doubles; }
+        std::span<const std::string> string_values()  const { return strings; }
+
+        // Numeric value of a row, throws for string columns.
+        double number(size_t row) const;
+
+        // Row value as a JSON literal.
+        std::string json(size_t row) const;
+
+        double                sum() const;
+        std::optional<double> min() const;
+        std::optional<double> max() const;
+    };
+
+    // Result set stored column by column, for aggregating over many rows without allocating a model per row.
+    // Fetch one with columnar(), ideally after select() so only the needed columns are transferred.
+    class column_set {
+    private:
+        std::vector<column> columns;
+        size_t              rows = 0;
+
+    public:
+        struct aggregate {
+            size_t                count = 0; // rows where the value isn't null
+            double                sum   = 0;
+            std::optional<double> min;
+            std::optional<double> max;
+        };
+
+        column_set() = default;
+        column_set(std::vector<std::string> names);
+
+        // Appends a row holding one value per column, in the order the columns were given.
+        void push_row(std::span<const serialized> values);
+
+        size_t size()         const { return rows; }
+        size_t column_count() const { return columns.size(); }
+
+        const std::vector<column>& get_columns() const { return columns; }
+
+        // Throws std::out_of_range if the result set has no column of that name.
+        const column& operator[](std::string_view name) const;
+
+        double                sum(std::string_view name) const { return (*this)[name].sum(); }
+        std::optional<double> min(std::string_view name) const { return (*this)[name].min(); }
+        std::optional<double> max(std::string_view name) const { return (*this)[name].max(); }
+
+        // Aggregates value_column per distinct value of key_column. Rows with a null key are grouped under
+        // std::nullopt.
+        std::map<std::optional<std::string>, aggregate> group_by(std::string_view key_column,
+                                                                 std::string_view value_column) const;
+
+        // Writes the rows as a JSON array of objects straight from the columns.
+        std::string to_json() const;
+    };
+}
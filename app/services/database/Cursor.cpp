@@ -0,0 +1,202 @@
+#include "Cursor.hpp"
+#include "Table.hpp"
+#include "../tools/Base64.hpp"
+#include "../tools/Hmac.hpp"
+
+#include <cctype>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace db {
+    std::string cursor::secret;
+
+    // Length of the HMAC-SHA-256 signature following the payload.
+    static constexpr size_t signature_size = 32;
+
+    static const std::string& get_secret() {
+        if (cursor::secret.empty()) {
+            throw std::logic_error("Cannot use pagination cursors: db::cursor::secret is not set.");
+        }
+
+        return cursor::secret;
+    }
+
+    static bool is_valid_key(const std::string& key) {
+        if (key.empty() || (key[0] >= '0' && key[0] <= '9'))
+            return false;
+
+        for (char c : key)
+            if (!std::isalnum((unsigned char)c) && c != '_' && c != '.')
+                return false;
+
+        return true;
+    }
+
+    static std::string format_floating_point(long double value) {
+        std::ostringstream stream;
+
+        stream << std::setprecision(std::numeric_limits<long double>::max_digits10) << value;
+
+        return stream.str();
+    }
+
+    cursor cursor::decode(const std::string& token) {
+        const std::string& key = get_secret();
+        std::string        payload;
+
+        try {
+            payload = decode_base64url(token);
+        } catch (std::invalid_argument& e) {
+            throw std::invalid_argument("Invalid pagination cursor.");
+        }
+
+        if (payload.size() < signature_size) {
+            throw std::invalid_argument("Invalid pagination cursor.");
+        }
+
+        std::string signature = payload.substr(payload.size() - signature_size);
+
+        payload.resize(payload.size() - signature_size);
+
+        if (!equals_constant_time(signature, hmac_sha256(key, payload))) {
+            throw std::invalid_argument("Invalid pagination cursor.");
+        }
+
+        size_t key_end   = payload.find('\n');
+        size_t separator = key_end == payload.npos ? payload.npos : payload.find('\n', key_end + 1);
+
+        if (separator == payload.npos || payload.size() < separator + 3) {
+            throw std::invalid_argument("Invalid pagination cursor.");
+        }
+
+        cursor c;
+
+        c.key = payload.substr(0, key_end);
+
+        if (!is_valid_key(c.key)) {
+            throw std::invalid_argument("Invalid pagination cursor.");
+        }
+
+        try {
+            size_t      parsed = 0;
+            std::string id     = payload.substr(key_end + 1, separator - key_end - 1);
+
+            c.id = std::to_string(std::stoull(id, &parsed));
+
+            if (parsed != id.size() || !std::isdigit((unsigned char)id[0])) {
+                throw std::invalid_argument("Invalid pagination cursor.");
+            }
+        } catch (std::logic_error& e) {
+            throw std::invalid_argument("Invalid pagination cursor.");
+        }
+
+        char        direction = payload[separator + 1];
+        char        type      = payload[separator + 2];
+        std::string value     = payload.substr(separator + 3);
+
+        if (direction != '+' && direction != '-') {
+            throw std::invalid_argument("Invalid pagination cursor.");
+        }
+
+        c.asc = direction == '+';
+
+        // The value ends up in a query, so it is parsed and re-rendered instead of trusted as-is.
+        try {
+            size_t parsed = 0;
+
+            switch (type) {
+                case 'i': c.value = std::to_string(std::stoll(value, &parsed));        break;
+                case 'f': c.value = format_floating_point(std::stold(value, &parsed)); break;
+                case 's': {
+                    c.value = "\"";
+
+                    for (char ch : value) {
+                        if (ch == '"' || ch == '\\') c.value += '\\';
+                        c.value += ch;
+                    }
+
+                    c.value += "\"";
+                    parsed   = value.size();
+                    break;
+                }
+                default: throw std::invalid_argument("Invalid pagination cursor.");
+            }
+
+            if (parsed != value.size()) {
+                throw std::invalid_argument("Invalid pagination cursor.");
+            }
+        } catch (std::logic_error& e) {
+            throw std::invalid_argument("Invalid pagination cursor.");
+        }
+
+        return c;
+    }
+
+    std::string cursor::encode(base_model& m, const std::string& key, bool asc) {
+        auto  properties = cursor { }.get_properties(m);
+        auto  it         = properties.find(key);
+        auto  id         = properties.find("id");
+
+        if (it == properties.end()) {
+            throw std::logic_error("Cannot paginate on \"" + key + "\": the model has no such property.");
+        }
+
+        if (id == properties.end()) {
+            throw std::logic_error("Cannot paginate on \"" + key + "\": the model has no id.");
+        }
+
+        std::string payload = key + '\n';
+
+        id->second->visit([&](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+
+            if constexpr (std::same_as<T, long long>) payload += std::to_string(value);
+            else throw std::logic_error("Cannot paginate on \"" + key + "\": the model id is not an integer.");
+        });
+
+        payload += '\n';
+        payload += asc ? '+' : '-';
+
+        it->second->visit([&](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+
+            if      constexpr (std::same_as<T, long long>)        payload += 'i' + std::to_string(            value);
+            else if constexpr (std::same_as<T, bool>)             payload += 'i' + std::to_string((long long) value);
+            else if constexpr (std::same_as<T, long double>)      payload += 'f' + format_floating_point(     value);
+            else if constexpr (std::same_as<T, std::string_view>) payload += 's' + std::string(               value);
+            else throw std::logic_error("Cannot paginate on \"" + key + "\": the value cannot be used as a cursor.");
+        });
+
+        return encode_base64url(payload + hmac_sha256(get_secret(), payload));
+    }
+
+    page IExecutable::paginate() const {
+        if (order_bys.empty()) {
+            throw std::logic_error("Cannot paginate an unordered query, use order_by() or after() first.");
+        }
+
+        auto& order = order_bys.front();
+        auto  id    = cursor::id_key(order.key);
+        auto  query = *this;
+
+        // Tokens continue after the last id among the rows sharing the last key, so those rows must come
+        // in id order.
+        if (std::none_of(order_bys.begin(), order_bys.end(), [&](auto& o) { return o.key == id; })) {
+            query.order_bys.push_back({ .key = id, .asc = order.asc });
+        }
+
+        page result {
+            .models = query.get()
+        };
+
+        // A short page means there is nothing left to fetch.
+        if (limit != (size_t)-1 && !result.models.empty() && result.models.size() == limit) {
+            result.next = cursor::encode(*result.models.back(), order.key, order.asc);
+        }
+
+        return result;
+    }
+}
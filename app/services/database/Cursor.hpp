@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../serialization/Model.hpp"
+
+#include <vector>
+#include <memory>
+#include <string>
+
+namespace db {
+    class model;
+
+    // Keyset pagination cursor. Holds the ordering key, its direction and the last value and id seen on the
+    // previous page, so the next page can be fetched with an index seek instead of an OFFSET scan.
+    class cursor : private base_serializer {
+    public:
+        std::string key;
+        std::string value; // formatted as a query literal
+        std::string id;    // likewise
+        bool        asc = true;
+
+        // Key tokens are signed with, so clients can't make a token up to order or filter on another column.
+        // Must be set before paginating, and be the same in every process handing out or reading tokens.
+        static std::string secret;
+
+        // Parses an opaque token produced by encode(). Throws std::invalid_argument if it was not signed
+        // with secret.
+        static cursor      decode(const std::string& token);
+
+        // Builds an opaque token continuing after model m on the given key.
+        static std::string encode(base_model& m, const std::string& key, bool asc);
+
+        // The id column breaking ties on key, qualified by the same table as key.
+        static std::string id_key(const std::string& key) {
+            return key.substr(0, key.rfind('.') + 1) + "id";
+        }
+    };
+
+    struct page {
+        std::vector<std::shared_ptr<model>> models;
+
+        // Token to pass to after() for the next page, empty once the last page was reached.
+        std::string next;
+    };
+}
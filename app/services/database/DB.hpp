@@ -2,4 +2,6 @@
 
 #include "Model.hpp"
 #include "Table.hpp"
+#include "Relation.hpp"
+#include "Request.hpp"
 #include "Transaction.hpp"
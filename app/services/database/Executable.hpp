@@ -1,12 +1,16 @@
 #pragma once
 
 #include "Model.hpp"
+#include "Cursor.hpp"
+#include "Columnar.hpp"
 #include "../tools/Container.hpp"
 
 #include <vector>
 #include <memory>
 #include <string>
 #include <sstream>
+#include <format>
+#include <future>
 
 namespace db {
     class base_table;
@@ -20,55 +24,163 @@ namespace db {
         std::string key;
         std::string value;
         std::string query_operator;
+
+        // Keyset conditions on a key that may repeat also match the rows equal to value whose tiebreak_key
+        // is past tiebreak_value. Both are empty for plain conditions.
+        std::string tiebreak_key;
+        std::string tiebreak_value;
     };
 
+    // Renders a condition as SQL, passing its values through format so drivers can quote them or leave
+    // placeholders instead.
+    template<typename F>
+    std::string to_sql(const where_query_t& condition, F&& format) {
+        if (condition.tiebreak_key.empty()) {
+            return std::format("{} {} {}", condition.key, condition.query_operator, format(condition.value));
+        }
+
+        auto value = format(condition.value);
+
+        return std::format("({} {} {} OR {} = {} AND {} {} {})",
+                           condition.key, condition.query_operator, value,
+                           condition.key, value,
+                           condition.tiebreak_key, condition.query_operator, format(condition.tiebreak_value));
+    }
+
+    inline std::string to_sql(const where_query_t& condition) {
+        return to_sql(condition, [](const std::string& value) { return value; });
+    }
+
+    template<typename T>
+    std::string to_query_value(const T& value) {
+        std::ostringstream stream;
+
+        if constexpr (std::same_as<T, const char*> || std::same_as<T, char*> || std::same_as<T, std::string>) {
+            stream << "\"";
+        }
+
+        stream << value;
+
+        if constexpr (std::same_as<T, const char*> || std::same_as<T, char*> || std::same_as<T, std::string>) {
+            stream << "\"";
+        }
+
+        return stream.str();
+    }
+
+    class IOffsetable;
     class ILimitable;
     class IOrderable;
     class ISearchable;
 
     class IExecutable {
     protected:
+        friend class IOffsetable;
         friend class ILimitable;
         friend class IOrderable;
         friend class ISearchable;
 
         const base_table&                   t;
-              size_t                        limit = (size_t)-1;
+              size_t                        limit  = (size_t)-1;
+              size_t                        offset = 0;
               std::vector<order_by_query_t> order_bys;
               std::vector<where_query_t>    wheres;
+              std::vector<std::string>      columns;
+              std::vector<std::string>      relations;
 
         IExecutable(const base_table&                   t,
                           size_t                        limit,
+                          size_t                        offset,
                           std::vector<order_by_query_t> order_bys,
-                          std::vector<where_query_t>    wheres) :
+                          std::vector<where_query_t>    wheres,
+                          std::vector<std::string>      columns,
+                          std::vector<std::string>      relations) :
             t(t),
             limit(limit),
+            offset(offset),
             order_bys(order_bys),
-            wheres(wheres) { }
+            wheres(wheres),
+            columns(columns),
+            relations(relations) { }
+
+        void load_relations(const std::vector<model*>& parents) const;
 
     public:
         std::vector<std::shared_ptr<model>>    get() const;
-        void remove() const;
+
+        // Like get(), but returns the models by value in one contiguous vector instead of allocating each of
+        // them. Model must be the type stored in the queried table.
+        template<std::derived_from<model> Model>
+        std::vector<Model> get_values() const;
+
+        // Fetches the rows into typed column arrays instead of models, for aggregating over large result sets.
+        // Relations requested with with() are not loaded.
+        column_set columnar() const;
+        // Removes the matching rows and returns how many were removed. Ordered and limited deletes allow
+        // purging a large table in small steps, e.g. until order_by("id").limit(1000).remove() returns 0.
+        size_t remove() const;
+
+        // Runs get() on one of the db::async() workers, so independent queries can be waited on together.
+        // The query runs on a copy of its table, except for joined tables, which must outlive the future.
+        std::future<std::vector<std::shared_ptr<model>>> get_async() const;
+
+        // Fetches one page and a cursor for the next one. The query must be ordered (see after()). Only the
+        // first ordering key goes into the cursor, with the id breaking ties between rows sharing it.
+        page paginate() const;
+    };
+
+    class IOffsetable : public IExecutable {
+    protected:
+        friend class ILimitable;
+
+        IOffsetable(const base_table&                   t,
+                          size_t                        limit,
+                          size_t                        offset,
+                          std::vector<order_by_query_t> order_bys,
+                          std::vector<where_query_t>    wheres,
+                          std::vector<std::string>      columns,
+                          std::vector<std::string>      relations) :
+            IExecutable(t, limit, offset, order_bys, wheres, columns, relations) { }
+
+    public:
+        // Skipped rows are still scanned by the server, prefer after() for deep pagination.
+        IExecutable offset(size_t offset) {
+            return IExecutable {
+                t,
+                limit,
+                offset,
+                order_bys,
+                wheres,
+                columns,
+                relations
+            };
+        }
     };
     
-    class ILimitable : public IExecutable {
+    class ILimitable : public IOffsetable {
     protected:
         friend class IOrderable;
         friend class ISearchable;
 
         ILimitable(const base_table&                   t,
                          size_t                        limit,
+                         size_t                        offset,
                          std::vector<order_by_query_t> order_bys,
-                         std::vector<where_query_t>    wheres) :
-            IExecutable(t, limit, order_bys, wheres) { }
+                         std::vector<where_query_t>    wheres,
+                         std::vector<std::string>      columns,
+                         std::vector<std::string>      relations) :
+            IOffsetable(t, limit, offset, order_bys, wheres, columns, relations) { }
 
     public:
-        IExecutable limit(size_t limit) {
-            return IExecutable {
+        IOffsetable limit(size_t limit) {
+            return IOffsetable {
                 t,
                 limit,
+                0,
                 order_bys,
-                wheres
+                wheres,
+                columns,
+                relations
             };
         }
     };
@@ -79,9 +191,12 @@ namespace db {
 
         IOrderable(const base_table&                   t,
                          size_t                        limit,
+                         size_t                        offset,
                          std::vector<order_by_query_t> order_bys,
-                         std::vector<where_query_t>    wheres) :
-            ILimitable(t, limit, order_bys, wheres) { }
+                         std::vector<where_query_t>    wheres,
+                         std::vector<std::string>      columns,
+                         std::vector<std::string>      relations) :
+            ILimitable(t, limit, offset, order_bys, wheres, columns, relations) { }
 
     public:
         IOrderable order_by(std::string key, bool asc = true) {
@@ -95,8 +210,11 @@ namespace db {
             return IOrderable {
                 t,
                 (size_t)-1,
+                0,
                 order_bys,
-                wheres
+                wheres,
+                columns,
+                relations
             };
         }
     };
@@ -107,37 +225,67 @@ namespace db {
 
         ISearchable(const base_table&                   t,
                           size_t                        limit,
+                          size_t                        offset,
                           std::vector<order_by_query_t> order_bys,
-                          std::vector<where_query_t>    wheres) :
-            IOrderable(t, limit, order_bys, wheres) { }
+                          std::vector<where_query_t>    wheres,
+                          std::vector<std::string>      columns,
+                          std::vector<std::string>      relations) :
+            IOrderable(t, limit, offset, order_bys, wheres, columns, relations) { }
 
     public:
-        template<typename T>
-        // todo: swap order of value and query_operator...
-        ISearchable where(std::string key, T value, std::string query_operator) {
-            std::ostringstream stream;
-
-            if constexpr (std::same_as<T, const char*> || std::same_as<T, char*> || std::same_as<T, std::string>) {
-                stream << "\"";
+        // Only fetches the given columns, the other properties of the returned models keep their defaults
+        // and are left untouched by save(). "id" is always fetched so the models can still be saved.
+        ISearchable select(std::vector<std::string> columns) {
+            if (!contains(columns, std::string("id"))) {
+                columns.insert(columns.begin(), "id");
             }
 
-            stream << value;
+            return ISearchable {
+                t,
+                (size_t)-1,
+                0,
+                order_bys,
+                wheres,
+                columns,
+                relations
+            };
+        }
 
-            if constexpr (std::same_as<T, const char*> || std::same_as<T, char*> || std::same_as<T, std::string>) {
-                stream << "\"";
-            }
+        // Eager loads relationships declared on the model, each with one extra query for the whole result
+        // set. Nested relationships are separated by dots, e.g. with("comments.author").
+        ISearchable with(std::string relation) {
+            auto loaded_relations = relations;
 
+            loaded_relations.push_back(relation);
+
+            return ISearchable {
+                t,
+                (size_t)-1,
+                0,
+                order_bys,
+                wheres,
+                columns,
+                loaded_relations
+            };
+        }
+
+        template<typename T>
+        // todo: swap order of value and query_operator...
+        ISearchable where(std::string key, T value, std::string query_operator) {
             wheres.push_back(where_query_t {
                 .key = key,
-                .value = stream.str(),
+                .value = to_query_value(value),
                 .query_operator = query_operator
             });
 
             return ISearchable {
                 t,
                 (size_t)-1,
+                0,
                 { },
-                wheres
+                wheres,
+                columns,
+                relations
             };
         }
 
@@ -149,17 +297,7 @@ namespace db {
             stream << "(";
 
             for (auto it = values.begin(); it != values.end();) {
-                auto value = *it;
-
-                if constexpr (std::same_as<ValueType, const char*> || std::same_as<ValueType, char*> || std::same_as<ValueType, std::string>) {
-                    stream << "\"";
-                }
-
-                stream << value;
-
-                if constexpr (std::same_as<ValueType, const char*> || std::same_as<ValueType, char*> || std::same_as<ValueType, std::string>) {
-                    stream << "\"";
-                }
+                stream << to_query_value<ValueType>(*it);
 
                 if (++it != values.end()) {
                     stream << ",";
@@ -177,8 +315,70 @@ namespace db {
             return ISearchable {
                 t,
                 (size_t)-1,
+                0,
                 { },
-                wheres
+                wheres,
+                columns,
+                relations
+            };
+        }
+
+        // Keyset pagination: continues after the row where key was last_value. This turns into an index
+        // seek on key, so key should be indexed and unique (typically "id"). Rows sharing last_value are
+        // skipped, use the tokens of paginate() to page on a key that may repeat.
+        template<typename T>
+        ILimitable after(std::string key, T last_value, bool asc = true) {
+            auto ordering = order_bys;
+
+            ordering.push_back({ .key = key, .asc = asc });
+
+            wheres.push_back(where_query_t {
+                .key = key,
+                .value = to_query_value(last_value),
+                .query_operator = asc ? ">" : "<"
+            });
+
+            return ILimitable {
+                t,
+                (size_t)-1,
+                0,
+                ordering,
+                wheres,
+                columns,
+                relations
+            };
+        }
+
+        // Continues after a cursor token returned by paginate(), ordered by its key and then by id.
+        ILimitable after(const std::string& token) {
+            auto c        = cursor::decode(token);
+            auto ordering = order_bys;
+
+            where_query_t condition {
+                .key = c.key,
+                .value = c.value,
+                .query_operator = c.asc ? ">" : "<"
+            };
+
+            ordering.push_back({ .key = c.key, .asc = c.asc });
+
+            if (c.key != cursor::id_key(c.key)) {
+                condition.tiebreak_key   = cursor::id_key(c.key);
+                condition.tiebreak_value = c.id;
+
+                ordering.push_back({ .key = condition.tiebreak_key, .asc = c.asc });
+            }
+
+            wheres.push_back(condition);
+
+            return ILimitable {
+                t,
+                (size_t)-1,
+                0,
+                ordering,
+                wheres,
+                columns,
+                relations
             };
         }
     };
@@ -1,42 +1,101 @@
 #pragma once
 
 #include "../serialization/Model.hpp"
+#include "Schema.hpp"
+#include "Request.hpp"
+#include "../tools/Container.hpp"
 
+#include <map>
 #include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <cstddef>
+#include <concepts>
 
 namespace db {
     class table;
+    class base_table;
+    class base_relation;
 
     class model : public base_model {
     protected:
         friend class table;
+        friend class base_table;
+        friend class base_relation;
 
         bool created = false;
 
+        // Columns fetched through select(), null when the whole row was loaded. Shared by all the models
+        // of a result.
+        std::shared_ptr<const std::vector<std::string>> selected_columns;
+
     public:
         model() : id(this, "id", 0) { }
 
         property<size_t> id;
 
+        bool is_loaded(const std::string& column) const {
+            return !selected_columns || contains(*selected_columns, column);
+        }
+
         virtual void save() = 0;
         virtual void remove() = 0;
 
+        // Runs save() on one of the db::async() workers. The model must outlive the returned future.
+        std::future<void> save_async() {
+            return db::async([this] {
+                save();
+            });
+        }
+
         virtual std::string table_name() const = 0;
 
         virtual table* get_table() = 0;
+
+        // Declares column types and indexes for table::create() and table::migrate(). Columns left out
+        // get a type inferred from their property.
+        virtual void define_schema(schema& s) const { }
     };
 
-    /* class joined_model : public base_model {
+    // A row fetched from a joined_table, holding one model per joined table from left to right. Tables
+    // without a matching row in a left or right join are left as nullptr.
+    class joined_model : public model {
     protected:
-        property<std::vector<std::shared_ptr<base_model>>> models;
+        std::vector<std::shared_ptr<model>> models;
 
     public:
-        joined_model() : models(this, "models") { }
+        joined_model(std::vector<std::shared_ptr<model>> models) : models(models) { }
 
-        std::vector<std::shared_ptr<base_model>>& get_models() {
+        std::vector<std::shared_ptr<model>>& get_models() {
             return models;
         }
-    }; */
+
+        // Returns the first joined model of the given type, or nullptr if there is none.
+        template<std::derived_from<model> Model>
+        std::shared_ptr<Model> get() const {
+            for (auto& m : models)
+                if (auto match = std::dynamic_pointer_cast<Model>(m))
+                    return match;
+
+            return nullptr;
+        }
+
+        void save() {
+            for (auto& m : models)
+                if (m) m->save();
+        }
+
+        void remove() {
+            for (auto& m : models)
+                if (m) m->remove();
+        }
+
+        std::string table_name() const { return ""; }
+
+        table* get_table() { return nullptr; }
+    };
 }
 
 #include "Table.hpp"
+#include "Relation.hpp"
@@ -0,0 +1,73 @@
+#include "Relation.hpp"
+#include "../tools/Format.hpp"
+
+#include <set>
+#include <stdexcept>
+
+namespace db {
+    void base_relation::register_relation(model* owner) {
+        register_member(owner);
+    }
+
+    base_relation* base_relation::find(model* m, const std::string& name) {
+        return dynamic_cast<base_relation*>(property_layout::find_member(*m, name));
+    }
+
+    long long base_relation::key_of(base_model& m, const std::string& key) const {
+        auto  properties = get_properties(m);
+        auto  it         = properties.find(key);
+
+        if (it == properties.end()) {
+            throw std::runtime_error(::format("Cannot load relationship \"{}\": the model has no \"{}\" property.", name, key));
+        }
+
+        if (it->second->serialized_type() != serialized::integer) {
+            throw std::runtime_error(::format("Cannot load relationship \"{}\": \"{}\" is not an integer key.", name, key));
+        }
+
+        long long value = 0;
+
+        it->second->visit([&](auto&& v) {
+            if constexpr (std::same_as<std::decay_t<decltype(v)>, long long>) value = v;
+        });
+
+        return value;
+    }
+
+    void base_relation::load(const std::vector<model*>& models, const std::string& path) {
+        if (models.empty()) {
+            return;
+        }
+
+        size_t      separator = path.find('.');
+        std::string name      = path.substr(0, separator);
+
+        auto r = find(models.front(), name);
+
+        if (!r) {
+            throw std::runtime_error(::format("Cannot load relationship \"{}\": the model does not declare it.", name));
+        }
+
+        r->eager_load(models);
+
+        if (separator == path.npos) {
+            return;
+        }
+
+        // The same related model can be shared by several parents, it only needs loading once.
+        std::vector<model*> related;
+        std::set<model*>    seen;
+
+        for (auto m : models) {
+            if (auto parent_relation = find(m, name)) {
+                for (auto& child : parent_relation->related()) {
+                    if (child && seen.insert(child.get()).second) {
+                        related.push_back(child.get());
+                    }
+                }
+            }
+        }
+
+        load(related, path.substr(separator + 1));
+    }
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "Model.hpp"
+#include "Table.hpp"
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <cstddef>
+#include <concepts>
+
+namespace db {
+    class base_relation : public    layout_member,
+                          protected base_serializer {
+    protected:
+        friend class IExecutable;
+
+        std::string name;
+        bool        loaded = false;
+
+        // Distance from the owning model to this relation. Unlike a pointer it stays valid when the model
+        // is copied or moved, since the copy has the same layout.
+        ptrdiff_t   owner_offset;
+
+        base_relation(model* owner, std::string name) :
+            name(name),
+            owner_offset((const char*)this - (const char*)owner) { register_relation(owner); }
+
+        model* owner() { return (model*)((char*)this - owner_offset); }
+
+        base_relation(const base_relation& ) = default;
+        base_relation(      base_relation&&) = default;
+
+        base_relation& operator=(const base_relation& ) = default;
+        base_relation& operator=(      base_relation&&) = default;
+
+        void register_relation(model* owner);
+
+        const std::string& member_name() const { return name; }
+
+        static base_relation* find(model* m, const std::string& name);
+
+        // Reads an integer key (an id or a foreign key) from a model.
+        long long key_of(base_model& m, const std::string& key) const;
+
+        // Loads a relation, or a dotted path of nested relations such as "comments.author", for all models at once.
+        static void load(const std::vector<model*>& models, const std::string& path);
+
+    public:
+        // Fetches this relation for every parent with a single query and assigns the results to each of them.
+        virtual void eager_load(const std::vector<model*>& parents) = 0;
+
+        virtual std::vector<std::shared_ptr<model>> related() const = 0;
+
+        bool is_loaded() const { return loaded; }
+    };
+
+    // Relation between the owner's local_key and the related model's remote_key. Many relations hold any
+    // number of related models, the others at most one.
+    template<std::derived_from<table> TableT, bool many>
+    class relation : public base_relation {
+    public:
+        using model_type = typename TableT::model_type;
+
+    protected:
+        std::string local_key;
+        std::string remote_key;
+
+        std::vector<std::shared_ptr<model_type>> models;
+
+        relation(model* owner, std::string name, std::string local_key, std::string remote_key) :
+            base_relation(owner, name),
+            local_key(local_key),
+            remote_key(remote_key) { }
+
+    public:
+        void eager_load(const std::vector<model*>& parents) {
+            std::vector<long long>                      keys;
+            std::map<long long, std::vector<relation*>> by_key;
+
+            for (auto parent : parents) {
+                auto r = dynamic_cast<relation*>(find(parent, name));
+
+                if (!r) {
+                    continue;
+                }
+
+                r->models.clear();
+                r->loaded = true;
+
+                long long key = key_of(*parent, local_key);
+
+                if (!by_key.contains(key)) {
+                    keys.push_back(key);
+                }
+
+                by_key[key].push_back(r);
+            }
+
+            if (keys.empty()) {
+                return;
+            }
+
+            // Keys are sent batch_size at a time, so the IN lists stay below the server's packet size limit.
+            size_t chunk = std::max<size_t>(1, TableT().batch_size);
+
+            for (size_t first = 0; first < keys.size(); first += chunk) {
+                std::vector<long long> batch(keys.begin() + first, keys.begin() + std::min(keys.size(), first + chunk));
+
+                // The query builder adds its conditions to the table it is called on, so every batch gets its own.
+                TableT t;
+
+                for (auto& m : t.whereIn(remote_key, batch).get()) {
+                    auto related = std::dynamic_pointer_cast<model_type>(m);
+
+                    for (auto r : by_key[key_of(*m, remote_key)]) {
+                        if (many || r->models.empty()) {
+                            r->models.push_back(related);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<std::shared_ptr<model>> related() const {
+            return std::vector<std::shared_ptr<model>>(models.begin(), models.end());
+        }
+
+        // Returns the related models, querying them for this model alone if they were not eager loaded.
+        std::vector<std::shared_ptr<model_type>>& get() requires(many) {
+            if (!loaded) eager_load({ owner() });
+
+            return models;
+        }
+
+        std::shared_ptr<model_type> get() requires(!many) {
+            if (!loaded) eager_load({ owner() });
+
+            return models.empty() ? nullptr : models.front();
+        }
+    };
+
+    // The related models hold this model's id in foreign_key, e.g. a post has many comments.
+    template<std::derived_from<table> TableT>
+    class has_many : public relation<TableT, true> {
+    public:
+        has_many(model* owner, std::string name, std::string foreign_key, std::string local_key = "id") :
+            relation<TableT, true>(owner, name, local_key, foreign_key) { }
+    };
+
+    // The related model holds this model's id in foreign_key, e.g. a user has one profile.
+    template<std::derived_from<table> TableT>
+    class has_one : public relation<TableT, false> {
+    public:
+        has_one(model* owner, std::string name, std::string foreign_key, std::string local_key = "id") :
+            relation<TableT, false>(owner, name, local_key, foreign_key) { }
+    };
+
+    // This model holds the related model's id in foreign_key, e.g. a comment belongs to a post.
+    template<std::derived_from<table> TableT>
+    class belongs_to : public relation<TableT, false> {
+    public:
+        belongs_to(model* owner, std::string name, std::string foreign_key, std::string owner_key = "id") :
+            relation<TableT, false>(owner, name, foreign_key, owner_key) { }
+    };
+}
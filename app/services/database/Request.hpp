@@ -0,0 +1,136 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+namespace db {
+    // State of the logical request a thread works for. It is shared with the threads started through
+    // async(), so what one of them does on behalf of the request is visible to the others.
+    struct request {
+        // Set once the request wrote to the primary, see mysql::connection::set_read_your_writes().
+        std::atomic<bool> written { false };
+
+        // The request of the current thread, created on first use.
+        static std::shared_ptr<request>& current() {
+            static thread_local std::shared_ptr<request> state;
+
+            if (!state) {
+                state = std::make_shared<request>();
+            }
+
+            return state;
+        }
+
+        // Starts a new request on the current thread. Threads still working for the previous one keep it.
+        static void reset() {
+            current() = std::make_shared<request>();
+        }
+    };
+
+    // Number of threads running the tasks of async(). Only read when the first task is started.
+    inline size_t async_workers = 8;
+
+    // Fixed set of threads running queued tasks. The threads live as long as the process, so the connections
+    // they open are reused by the tasks that follow instead of being opened for every task.
+    class worker_pool {
+    private:
+        std::mutex                        mutex;
+        std::condition_variable           ready;
+        std::deque<std::function<void()>> tasks;
+        std::vector<std::thread>          workers;
+        bool                              stopping = false;
+
+        void work() {
+            while (true) {
+                std::function<void()> task;
+
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+
+                    ready.wait(lock, [&] { return stopping || !tasks.empty(); });
+
+                    if (tasks.empty()) {
+                        return;
+                    }
+
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+
+                task();
+            }
+        }
+
+    public:
+        explicit worker_pool(size_t size) {
+            for (size_t i = 0; i < std::max<size_t>(1, size); i++) {
+                workers.emplace_back([this] { work(); });
+            }
+        }
+
+        // Runs the tasks still queued, then stops the threads.
+        ~worker_pool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                stopping = true;
+            }
+
+            ready.notify_all();
+
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        }
+
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                tasks.push_back(std::move(task));
+            }
+
+            ready.notify_one();
+        }
+
+        static worker_pool& get_instance() {
+            static worker_pool pool(async_workers);
+
+            return pool;
+        }
+    };
+
+    // Runs f on one of the async_workers threads, working for the same request as the caller. Tasks beyond
+    // async_workers wait for a thread, so f must not wait on another task started through async().
+    template<class F>
+    auto async(F&& f) {
+        using result = std::invoke_result_t<std::decay_t<F>&>;
+
+        auto task = std::make_shared<std::packaged_task<result()>>([state = request::current(), f = std::forward<F>(f)]() mutable {
+            request::current() = state;
+
+            // Workers outlive the task, they must not keep working for its request.
+            struct restore {
+                ~restore() { request::current() = nullptr; }
+            } restore;
+
+            return f();
+        });
+
+        auto future = task->get_future();
+
+        worker_pool::get_instance().submit([task] { (*task)(); });
+
+        return future;
+    }
+}
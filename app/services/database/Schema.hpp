@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace db {
+    struct column_definition {
+        std::string name;
+        std::string type;
+        bool        nullable = false;
+
+        // Set for types guessed from the property, which never override what is already in the database.
+        bool        inferred = false;
+    };
+
+    struct index_definition {
+        std::string              name;
+        std::vector<std::string> columns;
+        bool                     unique = false;
+    };
+
+    // Columns and indexes of a table, as declared by model::define_schema().
+    class schema {
+    public:
+        std::vector<column_definition> columns;
+        std::vector<index_definition>  indexes;
+
+        // Sets the SQL type of a column, e.g. column("body", "text").
+        schema& column(std::string name, std::string type, bool nullable = false) {
+            auto it = std::find_if(columns.begin(), columns.end(), [&name](auto& c) { return c.name == name; });
+
+            if (it != columns.end()) {
+                *it = { .name = name, .type = type, .nullable = nullable };
+            } else {
+                columns.push_back({ .name = name, .type = type, .nullable = nullable });
+            }
+
+            return *this;
+        }
+
+        // Adds an index on the columns, in order. Indexes are matched by name, which defaults to the
+        // column names. A composite index whose leading columns match a where() and whose remaining ones
+        // hold the selected columns covers the query, so it is answered from the index alone.
+        schema& index(std::vector<std::string> columns, bool unique = false, std::string name = "") {
+            if (name.empty()) {
+                name = unique ? "uq" : "idx";
+
+                for (auto& column : columns) {
+                    name += "_" + column;
+                }
+            }
+
+            indexes.push_back({ .name = name, .columns = columns, .unique = unique });
+
+            return *this;
+        }
+
+        schema& unique(std::vector<std::string> columns, std::string name = "") {
+            return index(columns, true, name);
+        }
+
+        const column_definition* find_column(const std::string& name) const {
+            auto it = std::find_if(columns.begin(), columns.end(), [&name](auto& c) { return c.name == name; });
+
+            return it == columns.end() ? nullptr : &*it;
+        }
+    };
+}
@@ -1,21 +1,83 @@
 #include "Table.hpp"
+#include "Relation.hpp"
+#include "../tools/Format.hpp"
+
+#include <stdexcept>
 
 namespace db {
     std::vector<std::shared_ptr<model>> IExecutable::get() const {
-        return t.get(wheres,
-                     order_bys,
-                     limit);
+        auto models = t.get(wheres,
+                            order_bys,
+                            limit,
+                            offset,
+                            columns);
+
+        if (!relations.empty()) {
+            std::vector<model*> parents;
+
+            for (auto& m : models) {
+                parents.push_back(m.get());
+            }
+
+            load_relations(parents);
+        }
+
+        return models;
+    }
+
+    void IExecutable::load_relations(const std::vector<model*>& parents) const {
+        for (auto& relation : relations) {
+            base_relation::load(parents, relation);
+        }
+    }
+
+    column_set IExecutable::columnar() const {
+        return t.get_columnar(wheres,
+                              order_bys,
+                              limit,
+                              offset,
+                              columns);
+    }
+
+    std::future<std::vector<std::shared_ptr<model>>> IExecutable::get_async() const {
+        // The table may be a temporary that is gone by the time the query runs.
+        return db::async([query = *this, owned = t.copy()] {
+            if (!owned) {
+                return query.get();
+            }
+
+            return IExecutable { *owned, query.limit, query.offset, query.order_bys, query.wheres, query.columns, query.relations }.get();
+        });
     }
 
-    void IExecutable::remove() const {
-        t.remove(wheres,
-                 order_bys,
-                 limit);
+    size_t IExecutable::remove() const {
+        return t.remove(wheres,
+                        order_bys,
+                        limit);
     }
 
     std::vector<std::shared_ptr<model>> base_table::all() const {
         return get({ },
                    { },
-                   -1);
+                   -1,
+                   0,
+                   { });
+    }
+
+    void base_table::get_into(std::vector<where_query_t>     wheres,
+                              std::vector<order_by_query_t>  order_bys,
+                              size_t                         limit,
+                              size_t                         offset,
+                              std::vector<std::string>       columns,
+                              const std::function<model&()>& next) const {
+        throw std::runtime_error(::format("Cannot fetch models by value: table \"{}\" does not support it.", name));
+    }
+
+    column_set base_table::get_columnar(std::vector<where_query_t>    wheres,
+                                        std::vector<order_by_query_t> order_bys,
+                                        size_t                        limit,
+                                        size_t                        offset,
+                                        std::vector<std::string>      columns) const {
+        throw std::runtime_error(::format("Cannot fetch columns: table \"{}\" does not support it.", name));
     }
 }
@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <functional>
 
 namespace db {
     enum join_mode_t {
@@ -27,26 +28,62 @@ namespace db {
 
         virtual std::vector<std::shared_ptr<model>> get(std::vector<where_query_t>    wheres,
                                                         std::vector<order_by_query_t> order_bys,
-                                                        size_t                        limit) const = 0;
-
-        virtual void remove(std::vector<where_query_t>    wheres,
-                            std::vector<order_by_query_t> order_bys,
-                            size_t                        limit) const = 0;
+                                                        size_t                        limit,
+                                                        size_t                        offset,
+                                                        std::vector<std::string>      columns) const = 0;
+
+        // Like get(), but deserializes each row into the model returned by next() instead of allocating one,
+        // so the caller decides where the models live. Tables that can't do this throw.
+        virtual void get_into(std::vector<where_query_t>     wheres,
+                              std::vector<order_by_query_t>  order_bys,
+                              size_t                         limit,
+                              size_t                         offset,
+                              std::vector<std::string>       columns,
+                              const std::function<model&()>& next) const;
+
+        // Like get(), but stores the rows column by column. Tables that can't do this throw.
+        virtual column_set get_columnar(std::vector<where_query_t>    wheres,
+                                        std::vector<order_by_query_t> order_bys,
+                                        size_t                        limit,
+                                        size_t                        offset,
+                                        std::vector<std::string>      columns) const;
+
+        // Returns the number of removed rows.
+        virtual size_t remove(std::vector<where_query_t>    wheres,
+                              std::vector<order_by_query_t> order_bys,
+                              size_t                        limit) const = 0;
 
         bool joined = false;
 
+        static void set_selected_columns(model& m, std::shared_ptr<const std::vector<std::string>> columns) { m.selected_columns = std::move(columns); }
+
+        // Shared list of selected columns for the models of one result, null when whole rows were loaded.
+        static std::shared_ptr<const std::vector<std::string>> share_columns(const std::vector<std::string>& columns) {
+            return columns.empty() ? nullptr : std::make_shared<const std::vector<std::string>>(columns);
+        }
+        static void set_created         (model& m)                                { m.created = true; }
+
         virtual std::shared_ptr<joined_table> join(const base_table& that,
                                                    std::string this_key,
                                                    std::string that_key,
                                                    join_mode_t mode = join_mode_t::inner) const = 0;
 
     public:
-        base_table() : ISearchable(*this, -1, { }, { }) { }
+        base_table() : ISearchable(*this, -1, 0, { }, { }, { }, { }) { }
         base_table(const base_table& ) = default;
         base_table(      base_table&&) = default;
 
         std::vector<std::shared_ptr<model>> all() const;
 
+        const std::string& get_name() const { return name; }
+
+        // Creates an empty model of the type stored in this table, nullptr for joined tables.
+        virtual std::shared_ptr<model> new_model() const { return nullptr; }
+
+        // A copy of this table for a query that may outlive it. nullptr for joined tables, which refer to the
+        // tables they join and can't be copied on their own.
+        virtual std::shared_ptr<const base_table> copy() const { return nullptr; }
+
         std::shared_ptr<joined_table>       join(const base_table& that,
                                                  std::string this_key,
                                                  std::string that_key) { return join(that, this_key, that_key, join_mode_t::inner); }
@@ -82,10 +119,16 @@ namespace db {
         table& operator=(      table&&) = default;
 
         virtual void insert(std::vector<std::shared_ptr<db::model>> models) = 0;
+        virtual void upsert(std::vector<std::shared_ptr<db::model>> models) = 0;
+        virtual void update(std::vector<std::shared_ptr<db::model>> models) = 0;
         virtual void remove(std::vector<std::shared_ptr<db::model>> models) const = 0;
         virtual void create() const = 0;
         virtual void destroy() const = 0;
         virtual void clear() const = 0;
+
+        // Alters the table to match the model's schema, creating it if it doesn't exist yet. Columns that
+        // are no longer declared are only dropped when drop_columns is set.
+        virtual void migrate(bool drop_columns = false) const = 0;
     };
 
     struct join_t {
@@ -110,8 +153,35 @@ namespace db {
             }
         }
 
+        static void add_tables(const base_table* t, std::vector<const base_table*>& tables) {
+            if (t->joined) {
+                auto nested = ((const joined_table*)t)->get_tables();
+
+                tables.insert(tables.end(), nested.begin(), nested.end());
+            } else {
+                tables.push_back(t);
+            }
+        }
+
     protected:
+        // The first join is the one this table was created from, the ones after it come from nested joined tables.
         std::vector<join_t> joins;
+
+        static const joined_table* as_joined(const base_table* t) {
+            return t->joined ? (const joined_table*)t : nullptr;
+        }
+
+        const join_t& root() const { return joins.front(); }
+
+        // Tables taking part in this join, from left to right.
+        std::vector<const base_table*> get_tables() const {
+            std::vector<const base_table*> tables;
+
+            add_tables(root().this_table, tables);
+            add_tables(root().that_table, tables);
+
+            return tables;
+        }
         
         joined_table(const base_table* this_table,
                      const base_table* that_table,
@@ -125,9 +195,35 @@ namespace db {
                 .that_key   = that_key,
                 .mode       = mode
             });
+
+            joined = true;
             
             add_joins(this_table);
             add_joins(that_table);
         }
     };
+
+    template<std::derived_from<model> Model>
+    std::vector<Model> IExecutable::get_values() const {
+        std::vector<Model> models;
+
+        t.get_into(wheres,
+                   order_bys,
+                   limit,
+                   offset,
+                   columns,
+                   [&]() -> model& { return models.emplace_back(); });
+
+        if (!relations.empty()) {
+            std::vector<model*> parents;
+
+            for (auto& m : models) {
+                parents.push_back(&m);
+            }
+
+            load_relations(parents);
+        }
+
+        return models;
+    }
 }
@@ -1,4 +1,7 @@
 #include "Connection.hpp"
+#include "../tools/Format.hpp"
+
+#include <mutex>
 
 namespace mysql {
     std::string  connection::server   = "localhost";
@@ -7,15 +10,162 @@ namespace mysql {
     std::string  connection::user     = "root";
     std::string  connection::db_name  = "test";
 
-    connection::connection() :
+    std::vector<connection::replica> connection::replicas;
+    std::chrono::seconds             connection::replica_retry_delay = std::chrono::seconds(30);
+    std::atomic<size_t>              connection::next_replica        = 0;
+    bool                             connection::read_your_writes    = false;
+
+    std::mutex                                            connection::replica_mutex;
+
+    std::mutex                               connection::pool_mutex;
+    std::vector<std::unique_ptr<connection>> connection::pool;
+
+    thread_local connection::lease              connection::primary;
+    thread_local std::vector<connection::lease> connection::replica_instances;
+
+    connection::connection(std::string server, unsigned int port) :
         session(mysqlx::abi2::SessionSettings { server, port, user, password }),
         db(session,
            db_name) { }
 
+    connection::lease::~lease() {
+        // Transactions are scoped to the thread and already rolled back by now, this is only a safeguard.
+        if (!instance || instance->transactions > 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(pool_mutex);
+
+        (instance->replica_index ? replicas[*instance->replica_index].idle : pool).push_back(std::move(instance));
+    }
+
     connection& connection::get_instance() {
-        static auto instance = connection();
+        if (!primary.instance) {
+            std::unique_lock<std::mutex> lock(pool_mutex);
+
+            if (!pool.empty()) {
+                primary.instance = std::move(pool.back());
+                pool.pop_back();
+            } else {
+                lock.unlock();
+                primary.instance.reset(new connection(server, port));
+            }
+        }
+
+        return *primary.instance;
+    }
+
+    bool connection::transaction_open() {
+        return primary.instance && primary.instance->transactions > 0;
+    }
+
+    connection& connection::get_reader() {
+        // Reads going to a replica don't need a primary connection, so none is taken to check these.
+        if (replicas.empty() || transaction_open() || (read_your_writes && db::request::current()->written)) {
+            return get_instance();
+        }
+
+        replica_instances.resize(replicas.size());
+
+        // Try every replica once, starting from the next one in line, before falling back to the primary.
+        for (size_t attempt = 0; attempt < replicas.size(); attempt++) {
+            size_t index    = next_replica++ % replicas.size();
+            auto&  instance = replica_instances[index].instance;
+
+            if (instance) {
+                return *instance;
+            }
+
+            std::unique_lock<std::mutex> lock(replica_mutex);
+
+            auto now = std::chrono::steady_clock::now();
+
+            if (now < replicas[index].retry_after) {
+                continue;
+            }
+
+            auto server = replicas[index].server;
+            auto port   = replicas[index].port;
+
+            lock.unlock();
+
+            {
+                std::lock_guard<std::mutex> idle_lock(pool_mutex);
+
+                auto& idle = replicas[index].idle;
+
+                if (!idle.empty()) {
+                    instance = std::move(idle.back());
+                    idle.pop_back();
+
+                    return *instance;
+                }
+            }
+
+            try {
+                instance.reset(new connection(server, port));
+            } catch (std::exception& e) {
+                lock.lock();
+                replicas[index].retry_after = now + replica_retry_delay;
+                continue;
+            }
+
+            instance->replica_index = index;
+
+            return *instance;
+        }
+
+        return get_instance();
+    }
 
-        return instance;
+    bool connection::drop_replica(connection& conn) {
+        if (!conn.replica_index) {
+            return false;
+        }
+
+        size_t index = *conn.replica_index;
+
+        {
+            std::lock_guard<std::mutex> lock(replica_mutex);
+
+            replicas[index].retry_after = std::chrono::steady_clock::now() + replica_retry_delay;
+        }
+
+        replica_instances[index].instance.reset();
+
+        return true;
+    }
+
+    connection& connection::get_writer() {
+        db::request::current()->written = true;
+
+        return get_instance();
+    }
+
+    connection& connection::get_autocommit() {
+        static thread_local std::unique_ptr<connection> instance;
+
+        if (!instance) {
+            instance.reset(new connection(server, port));
+        }
+
+        return *instance;
+    }
+
+    void connection::add_replica(std::string server, unsigned int port) {
+        replicas.push_back({ .server = server, .port = port });
+    }
+
+    void connection::set_replica_retry_delay(std::chrono::seconds delay) {
+        replica_retry_delay = delay;
+    }
+
+    void connection::set_read_your_writes(bool enabled) {
+        read_your_writes = enabled;
+    }
+
+    void connection::end_request() {
+        db::request::reset();
     }
 
     transaction connection::begin() {
@@ -33,4 +183,41 @@ namespace mysql {
     std::string connection::get_db_name() {
         return db_name;
     }
+
+    std::string connection::explain(const std::string& sql) {
+        auto result = session.sql("EXPLAIN " + sql).execute();
+
+        std::vector<std::string> names;
+
+        for (auto& column : result.getColumns()) {
+            names.push_back(column.getColumnName());
+        }
+
+        std::string plan;
+
+        for (auto row : result) {
+            std::string line;
+
+            for (size_t i = 0; i < names.size(); i++) {
+                auto value = row.get(i);
+
+                std::string text;
+
+                switch (value.getType()) {
+                    case mysqlx::abi2::r0::Value::Type::VNULL:  text = "NULL";                                   break;
+                    case mysqlx::abi2::r0::Value::Type::UINT64: text = std::to_string((uint64_t)value);          break;
+                    case mysqlx::abi2::r0::Value::Type::INT64:  text = std::to_string((int64_t)value);           break;
+                    case mysqlx::abi2::r0::Value::Type::DOUBLE: text = std::to_string((double)value);            break;
+                    case mysqlx::abi2::r0::Value::Type::STRING: text = (std::string)value;                       break;
+                    default:                                    text = "?";                                      break;
+                }
+
+                line += ::format("{}{}={}", line.empty() ? "" : ", ", names[i], text);
+            }
+
+            plan += ::format("{}{}", plan.empty() ? "" : "; ", line);
+        }
+
+        return plan;
+    }
 }
@@ -2,12 +2,25 @@
 
 #include <mysql-cppconn-8/mysqlx/xdevapi.h>
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "Transaction.hpp"
+#include "../database/Request.hpp"
 
 namespace mysql {
     class connection {
     private:
-        connection();
+        friend class transaction;
+        friend class query_cache;
+
+        connection(std::string server, unsigned int port);
 
         static std::string  server;
         static unsigned int port;
@@ -15,17 +28,120 @@ namespace mysql {
         static std::string  password;
         static std::string  db_name;
 
+        struct replica {
+            std::string  server;
+            unsigned int port;
+
+            // A replica that could not be reached is skipped until then.
+            std::chrono::steady_clock::time_point retry_after;
+
+            // Connections left behind by finished threads, guarded by pool_mutex like the primary's.
+            std::vector<std::unique_ptr<connection>> idle;
+        };
+
+        static std::vector<replica> replicas;
+        static std::chrono::seconds replica_retry_delay;
+
+        static std::mutex           replica_mutex;
+        static std::atomic<size_t>  next_replica;
+        static bool                 read_your_writes;
+
+        // Primary connections left behind by finished threads, handed to the next thread that needs one.
+        static std::mutex                               pool_mutex;
+        static std::vector<std::unique_ptr<connection>> pool;
+
+        // A connection held by one thread, handed back to its server's pool when the thread exits.
+        struct lease {
+            std::unique_ptr<connection> instance;
+
+            lease() = default;
+            lease(lease&&) = default;
+
+            ~lease();
+        };
+
+        // Sessions can't be shared between threads, so every thread leases its own connections: one to the
+        // primary and one per replica, each empty until it is first needed.
+        static thread_local lease              primary;
+        static thread_local std::vector<lease> replica_instances;
+
+        // Depth of the open transactions, nested ones run as savepoints.
+        size_t transactions = 0;
+
+        // Index in replicas for replica connections.
+        std::optional<size_t> replica_index;
+
+        // Drops a replica connection that failed and skips its server for replica_retry_delay. Returns false,
+        // leaving the connection alone, for the primary.
+        static bool drop_replica(connection& conn);
+
+        // Tables written to in the open transaction, their cached queries are dropped when it commits.
+        std::set<std::string> written_tables;
+
     public:
+        // The primary server. Every thread gets its own connection, taken from the pool when one is idle.
         static connection& get_instance();
 
+        // Connection to run a read on: the next replica in round-robin order, or the primary when no
+        // replica is available, a transaction is open, or the current request already wrote with read_your_writes.
+        static connection& get_reader();
+
+        // Runs execute(connection&) on a reader and returns the connection it succeeded on. A replica that
+        // fails is dropped and the next one, or eventually the primary, is tried instead. Only the execution
+        // is retried, so execute should keep the result for the caller rather than consume it.
+        template<class F>
+        static connection& read(F&& execute) {
+            while (true) {
+                auto& conn = get_reader();
+
+                try {
+                    execute(conn);
+
+                    return conn;
+                } catch (mysqlx::Error& e) {
+                    if (!drop_replica(conn)) {
+                        throw;
+                    }
+                }
+            }
+        }
+
+        // Whether this thread has a transaction open on the primary, without taking a connection for it.
+        static bool transaction_open();
+
+        // The primary server, remembering the write for read_your_writes.
+        static connection& get_writer();
+
+        // A second connection of this thread to the primary that never opens a transaction, for writes that
+        // must commit on their own whatever the caller's transaction does, such as reserving ids.
+        static connection& get_autocommit();
+
         mysqlx::Session session;
         mysqlx::Schema  db;
 
+        // Starts a transaction, or a savepoint when one is already open on this connection.
         transaction begin();
 
         static void set_server  (std::string server);
         static void set_password(std::string password);
 
+        // Adds a read replica. Replicas must be configured before the first query is run.
+        static void add_replica(std::string server, unsigned int port = 33060);
+
+        // How long a replica that could not be connected to is skipped before trying it again.
+        static void set_replica_retry_delay(std::chrono::seconds delay);
+
+        // Sends reads to the primary once the current request wrote, so it always sees its own writes
+        // regardless of replication lag. The request is tracked through db::request, which save_async()
+        // and get_async() carry to their threads. Call end_request() between requests on long-lived workers.
+        static void set_read_your_writes(bool enabled);
+        static void end_request();
+
         std::string get_db_name();
+
+        bool in_transaction() const { return transactions > 0; }
+
+        // Runs EXPLAIN on a statement, returning one "column=value" list per row of the plan.
+        std::string explain(const std::string& sql);
     };
 }
@@ -1,5 +1,8 @@
 #include "Model.hpp"
 #include "Connection.hpp"
+#include "QueryCache.hpp"
+#include "Profiler.hpp"
+#include "Sequence.hpp"
 #include "../tools/Format.hpp"
 
 #include <stdexcept>
@@ -13,24 +16,23 @@ namespace mysql {
     // using serialized_t = std::variant<long long, long double, bool, std::nullptr_t, std::string, std::shared_ptr<base_model>, std::vector<std::shared_ptr<base_model>>>;
 
     // Utility function to extract ID from properties
-    long long extract_id(const std::map<std::string, base_property*>& properties) {
+    long long extract_id(const property_map& properties) {
         auto it = properties.find("id");
         if (it == properties.end() || it->second == nullptr) {
             throw std::runtime_error("ID property is missing.");
         }
 
-        auto serialized_id = it->second->serialize_value();
         long long id_value = 0;
         bool id_extracted = false;
 
-        std::visit([&id_value, &id_extracted](auto&& val) {
+        it->second->visit([&id_value, &id_extracted](auto&& val) {
             using T = std::decay_t<decltype(val)>;
             if constexpr (std::is_same_v<T, long long>) {
                 id_value = val;
                 id_extracted = true;
             }
             // Add other types if ID can have different types
-        }, serialized_id.value);
+        });
 
         if (!id_extracted) {
             throw std::runtime_error("ID property has an unexpected type.");
@@ -40,8 +42,13 @@ namespace mysql {
     }
 
     void model::save() {
-        auto& session = connection::get_instance().session;
-        auto& db      = connection::get_instance().db;
+        // Nothing changed since the model was loaded or last saved, skip the round trip entirely.
+        if (created && !is_dirty()) {
+            return;
+        }
+
+        auto& session = connection::get_writer().session;
+        auto& db      = connection::get_writer().db;
         auto  t       = db.getTable(table_name());
 
         if (!t.existsInDatabase()) {
@@ -52,11 +59,15 @@ namespace mysql {
             // Prepare the update statement with parameter binding
             auto update = t.update();
 
-            for(auto& property : sorted_properties) {
-                auto value = property.second->serialize_value();
-                
-                // Use std::visit to handle the variant and set parameters
-                std::visit([&update, &property](auto&& val) {
+            for(auto& property : sorted_properties()) {
+                // Only write the columns that changed. This also leaves alone the columns left out of a
+                // select(), which were never loaded and would otherwise clobber the row.
+                if (!property.second->is_dirty()) {
+                    continue;
+                }
+
+                // Visit the value in place to set parameters, rather than copying it into a serialized first
+                property.second->visit([&update, &property](auto&& val) {
                     using T = std::decay_t<decltype(val)>;
                     if constexpr (std::is_same_v<T, long long>) {
                         update.set(property.first, val);
@@ -70,28 +81,36 @@ namespace mysql {
                     else if constexpr (std::is_same_v<T, std::nullptr_t>) {
                         update.set(property.first, nullptr);
                     }
-                    else if constexpr (std::is_same_v<T, std::string>) {
-                        update.set(property.first, val);
+                    else if constexpr (std::is_same_v<T, std::string_view>) {
+                        update.set(property.first, std::string(val));
                     }
                     // Handle other types if necessary
-                }, value.value);
+                });
             }
 
             // Extract ID safely
-            long long id_value = extract_id(properties);
+            long long id_value = extract_id(properties());
 
             // Use bound parameter to prevent SQL injection
-            update.where("id = :id").bind("id", id_value).execute();
+            profiler::timer timer(::format("UPDATE `{}` SET ... WHERE `id` = ?", table_name()));
+
+            timer.finish(update.where("id = :id").bind("id", id_value).execute().getAffectedItemsCount());
+
+            mark_clean();
         } else {
+            // Ids come from the table's sequence rather than AUTO_INCREMENT, so a model can also be inserted
+            // with an id it was given beforehand.
+            if (id == 0) {
+                id = sequence::get(table_name()).next();
+            }
+
             mysqlx::Row row;
 
             size_t index = 0;
 
-            for(auto& property : sorted_properties) {
-                auto value = property.second->serialize_value();
-
-                // Set the row value based on the variant's type using std::visit
-                std::visit([&row, &index](auto&& val) {
+            for(auto& property : sorted_properties()) {
+                // Set the row value based on the visited value's type
+                property.second->visit([&row, &index](auto&& val) {
                     using T = std::decay_t<decltype(val)>;
                     if constexpr (std::is_same_v<T, long long>) {
                         row.set(index++, val);
@@ -105,28 +124,33 @@ namespace mysql {
                     else if constexpr (std::is_same_v<T, std::nullptr_t>) {
                         row.set(index++, nullptr);
                     }
-                    else if constexpr (std::is_same_v<T, std::string>) {
-                        row.set(index++, val);
+                    else if constexpr (std::is_same_v<T, std::string_view>) {
+                        row.set(index++, std::string(val));
                     }
                     // Handle other types if necessary
-                }, value.value);
+                });
             }
 
             // Insert the row using prepared statements
-            auto res = t.insert().values(row).execute();
+            profiler::timer timer(::format("INSERT INTO `{}` VALUES (...)", table_name()));
+
+            t.insert().values(row).execute();
 
-            // Retrieve the auto-incremented ID in a thread-safe manner
-            id = res.getAutoIncrementValue(); // Ensure 'id' is of a compatible type
+            timer.finish(1);
 
             created = true;
+
+            mark_clean();
         }
+
+        query_cache::invalidate(table_name());
     }
 
     void model::remove() {
         if(!created)
             return;
 
-        auto& db = connection::get_instance().db;
+        auto& db = connection::get_writer().db;
         auto t   = db.getTable(table_name());
 
         if (!t.existsInDatabase()) {
@@ -134,17 +158,21 @@ namespace mysql {
         }
 
         // Extract ID safely
-        long long id_value = extract_id(properties);
+        long long id_value = extract_id(properties());
 
         // Use bound parameter to prevent SQL injection
-        t.remove().where("id = :id").bind("id", id_value).execute();
+        profiler::timer timer(::format("DELETE FROM `{}` WHERE `id` = ?", table_name()));
+
+        timer.finish(t.remove().where("id = :id").bind("id", id_value).execute().getAffectedItemsCount());
+
+        query_cache::invalidate(table_name());
     }
 
     // Implementing batch insertion
     void model::save_multiple(const std::vector<std::shared_ptr<model>>& models) {
         if (models.empty()) return;
 
-        auto& db = connection::get_instance().db;
+        auto& db = connection::get_writer().db;
         auto t = db.getTable(table_name());
 
         if (!t.existsInDatabase()) {
@@ -154,15 +182,19 @@ namespace mysql {
         // Insert operation starts here, t.insert() returns a TableInsert statement
         auto insert_stmt = t.insert();
 
+        auto& ids = sequence::get(table_name());
+
         for(auto& mdl_ptr : models) {
+            if (mdl_ptr->id == 0) {
+                mdl_ptr->id = ids.next();
+            }
+
             mysqlx::Row row;
             size_t index = 0;
 
-            for(auto& property : mdl_ptr->sorted_properties) {
-                auto value = property.second->serialize_value();
-
-                // Set the row value based on the variant's type using std::visit
-                std::visit([&row, &index](auto&& val) {
+            for(auto& property : mdl_ptr->sorted_properties()) {
+                // Set the row value based on the visited value's type
+                property.second->visit([&row, &index](auto&& val) {
                     using T = std::decay_t<decltype(val)>;
                     if constexpr (std::is_same_v<T, long long>) {
                         row.set(index++, val);
@@ -176,10 +208,10 @@ namespace mysql {
                     else if constexpr (std::is_same_v<T, std::nullptr_t>) {
                         row.set(index++, nullptr);
                     }
-                    else if constexpr (std::is_same_v<T, std::string>) {
-                        row.set(index++, val);
+                    else if constexpr (std::is_same_v<T, std::string_view>) {
+                        row.set(index++, std::string(val));
                     }
-                }, value.value);
+                });
             }
 
             // Add the row to the batch insert
@@ -187,14 +219,18 @@ namespace mysql {
         }
 
         // Execute the batch insert
-        auto res = insert_stmt.execute();
+        profiler::timer timer(::format("INSERT INTO `{}` VALUES ...", table_name()));
+
+        insert_stmt.execute();
 
-        // Assign the auto-incremented IDs to the models
-        long long first_id = res.getAutoIncrementValue();
-        for(size_t i = 0; i < models.size(); ++i) {
-            models[i]->id = first_id + i;
-            models[i]->created = true;
+        timer.finish(models.size());
+
+        for(auto& mdl_ptr : models) {
+            mdl_ptr->created = true;
+            mdl_ptr->mark_clean();
         }
+
+        query_cache::invalidate(table_name());
     }
 
 }
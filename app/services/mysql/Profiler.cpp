@@ -0,0 +1,116 @@
+#include "Profiler.hpp"
+#include "../logging/Logstream.hpp"
+
+namespace mysql {
+    bool                      profiler::enabled        = false;
+    bool                      profiler::log_queries    = false;
+    bool                      profiler::explain_slow   = true;
+    std::chrono::milliseconds profiler::slow_threshold { 100 };
+
+    std::mutex                                 profiler::mutex;
+    std::set<profiler::thread_histograms*>     profiler::threads;
+    std::map<std::string, profiler::histogram> profiler::finished;
+
+    profiler::thread_histograms::thread_histograms() {
+        std::lock_guard<std::mutex> lock(profiler::mutex);
+
+        threads.insert(this);
+    }
+
+    profiler::thread_histograms::~thread_histograms() {
+        std::lock_guard<std::mutex> lock(profiler::mutex);
+        std::lock_guard<std::mutex> own(mutex);
+
+        merge(finished, histograms);
+        threads.erase(this);
+    }
+
+    void profiler::timer::finish(size_t rows, std::function<std::string()> explain) {
+        if (!enabled) {
+            return;
+        }
+
+        auto   elapsed = std::chrono::steady_clock::now() - start;
+        double ms      = std::chrono::duration<double, std::milli>(elapsed).count();
+        bool   slow    = elapsed >= slow_threshold;
+
+        record(shape, ms, rows);
+
+        if (!slow && !log_queries) {
+            return;
+        }
+
+        log << std::format("[mysql] {}{:.3f} ms, {} rows: {}\n", slow ? "slow query, " : "", ms, rows, shape);
+
+        if (slow && explain_slow && explain) {
+            // The statement already succeeded, a failing EXPLAIN should not turn it into an error.
+            try {
+                log << std::format("[mysql] plan: {}\n", explain());
+            } catch (std::exception& e) {
+                log << std::format("[mysql] plan unavailable: {}\n", e.what());
+            }
+        }
+    }
+
+    void profiler::record(const std::string& shape, double ms, size_t rows) {
+        static thread_local thread_histograms local;
+
+        std::lock_guard<std::mutex> lock(local.mutex);
+
+        auto& h = local.histograms[shape];
+
+        h.count++;
+        h.rows     += rows;
+        h.total_ms += ms;
+        h.max_ms    = std::max(h.max_ms, ms);
+
+        size_t bucket = 0;
+
+        while (bucket < bucket_bounds.size() && ms > bucket_bounds[bucket]) {
+            bucket++;
+        }
+
+        h.buckets[bucket]++;
+    }
+
+    void profiler::merge(std::map<std::string, histogram>& into, const std::map<std::string, histogram>& from) {
+        for (auto& [shape, h] : from) {
+            auto& merged = into[shape];
+
+            merged.count    += h.count;
+            merged.rows     += h.rows;
+            merged.total_ms += h.total_ms;
+            merged.max_ms    = std::max(merged.max_ms, h.max_ms);
+
+            for (size_t i = 0; i < h.buckets.size(); i++) {
+                merged.buckets[i] += h.buckets[i];
+            }
+        }
+    }
+
+    std::map<std::string, profiler::histogram> profiler::get_histograms() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto merged = finished;
+
+        for (auto t : threads) {
+            std::lock_guard<std::mutex> own(t->mutex);
+
+            merge(merged, t->histograms);
+        }
+
+        return merged;
+    }
+
+    void profiler::reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        finished.clear();
+
+        for (auto t : threads) {
+            std::lock_guard<std::mutex> own(t->mutex);
+
+            t->histograms.clear();
+        }
+    }
+}
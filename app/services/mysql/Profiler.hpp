@@ -0,0 +1,71 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <array>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <functional>
+
+namespace mysql {
+    // Times the statements run through mysql::table and mysql::model and aggregates them per shape: the
+    // statement with its values left out, so the same query with different arguments is counted once.
+    // Statements slower than slow_threshold are written to the log, along with their EXPLAIN output.
+    class profiler {
+    public:
+        // Upper bounds of the histogram buckets in milliseconds, the last bucket counts everything slower.
+        static constexpr std::array<double, 12> bucket_bounds { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000 };
+
+        struct histogram {
+            size_t count    = 0;
+            size_t rows     = 0;
+            double total_ms = 0;
+            double max_ms   = 0;
+
+            std::array<size_t, bucket_bounds.size() + 1> buckets { };
+        };
+
+        class timer {
+        private:
+            std::string                           shape;
+            std::chrono::steady_clock::time_point start;
+
+        public:
+            timer(std::string shape) : shape(shape), start(std::chrono::steady_clock::now()) { }
+
+            // Records the statement. explain returns the plan of the statement, it is only called when
+            // the statement was slow.
+            void finish(size_t rows, std::function<std::string()> explain = nullptr);
+        };
+
+        // Off by default. Statements are only timed and aggregated once this is set.
+        static bool                      enabled;
+        static bool                      log_queries;
+        static bool                      explain_slow;
+        static std::chrono::milliseconds slow_threshold;
+
+        // Merges the histograms recorded so far by every thread.
+        static std::map<std::string, histogram> get_histograms();
+        static void reset();
+
+    private:
+        // Each thread records into its own histograms, so timing a statement takes no lock shared with other
+        // threads. Their mutex is only contended by get_histograms() and reset().
+        struct thread_histograms {
+            std::mutex                       mutex;
+            std::map<std::string, histogram> histograms;
+
+            thread_histograms();
+            ~thread_histograms();
+        };
+
+        // Guards threads and the histograms of the threads that have exited.
+        static std::mutex                       mutex;
+        static std::set<thread_histograms*>     threads;
+        static std::map<std::string, histogram> finished;
+
+        static void record(const std::string& shape, double ms, size_t rows);
+        static void merge(std::map<std::string, histogram>& into, const std::map<std::string, histogram>& from);
+    };
+}
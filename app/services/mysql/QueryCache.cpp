@@ -0,0 +1,203 @@
+#include "QueryCache.hpp"
+#include "Connection.hpp"
+
+#include <format>
+#include <algorithm>
+
+namespace mysql {
+    std::mutex                                      query_cache::mutex;
+    std::map<std::string, query_cache::table_cache> query_cache::tables;
+    std::atomic<size_t>                             query_cache::enabled_tables = 0;
+
+    void query_cache::table_cache::erase(std::map<std::string, entry>::iterator it) {
+        recent.erase(it->second.position);
+        entries.erase(it);
+    }
+
+    void query_cache::table_cache::evict() {
+        if (entries.size() < max_entries) {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+
+        for (auto it = entries.begin(); it != entries.end(); ) {
+            if (it->second.expires < now) {
+                recent.erase(it->second.position);
+                it = entries.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        while (!recent.empty() && entries.size() >= max_entries) {
+            erase(entries.find(recent.back()));
+        }
+    }
+
+    void query_cache::enable(const std::string& table_name, std::chrono::milliseconds ttl, size_t max_entries) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto& cache = tables[table_name];
+
+        bool was_enabled = cache.ttl.count() > 0;
+        bool is_enabled  = ttl.count() > 0;
+
+        if (is_enabled != was_enabled) {
+            enabled_tables += is_enabled ? 1 : -1;
+        }
+
+        cache.ttl         = ttl;
+        cache.max_entries = max_entries;
+        cache.entries.clear();
+        cache.recent.clear();
+    }
+
+    void query_cache::disable(const std::string& table_name) {
+        enable(table_name, std::chrono::milliseconds(0));
+    }
+
+    bool query_cache::is_enabled(const std::string& table_name) {
+        if (enabled_tables.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = tables.find(table_name);
+
+        return it != tables.end() && it->second.ttl.count() > 0;
+    }
+
+    std::string query_cache::key(const std::vector<db::where_query_t>&    wheres,
+                                 const std::vector<db::order_by_query_t>& order_bys,
+                                       size_t                             limit,
+                                       size_t                             offset,
+                                 const std::vector<std::string>&          columns) {
+        // Conditions are ANDed together, so their order doesn't change the result.
+        std::vector<std::string> conditions;
+
+        for (auto& condition : wheres) {
+            conditions.push_back(db::to_sql(condition));
+        }
+
+        std::sort(conditions.begin(), conditions.end());
+
+        std::string key = "w";
+
+        for (auto& condition : conditions) {
+            key += std::format("{}\n", condition);
+        }
+
+        key += "o";
+
+        for (auto& condition : order_bys) {
+            key += std::format("{} {}\n", condition.key, condition.asc ? "ASC" : "DESC");
+        }
+
+        key += "c";
+
+        for (auto& column : columns) {
+            key += std::format("{}\n", column);
+        }
+
+        return key + std::format("l{}\no{}", limit, offset);
+    }
+
+    std::optional<query_cache::rows> query_cache::find(const std::string& table_name, const std::string& key, size_t& generation) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = tables.find(table_name);
+
+        if (it == tables.end() || it->second.ttl.count() == 0) {
+            return std::nullopt;
+        }
+
+        auto& cache = it->second;
+
+        generation = cache.generation;
+
+        auto match = cache.entries.find(key);
+
+        if (match == cache.entries.end() || match->second.expires < std::chrono::steady_clock::now()) {
+            if (match != cache.entries.end()) {
+                cache.erase(match);
+            }
+
+            cache.stats.misses++;
+
+            return std::nullopt;
+        }
+
+        cache.recent.splice(cache.recent.begin(), cache.recent, match->second.position);
+        cache.stats.hits++;
+
+        return match->second.result;
+    }
+
+    void query_cache::store(const std::string& table_name, const std::string& key, size_t generation, rows result) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = tables.find(table_name);
+
+        if (it == tables.end() || it->second.ttl.count() == 0 || it->second.generation != generation) {
+            return;
+        }
+
+        auto& cache = it->second;
+
+        if (auto match = cache.entries.find(key); match != cache.entries.end()) {
+            cache.erase(match);
+        }
+
+        cache.evict();
+
+        if (cache.max_entries == 0) {
+            return;
+        }
+
+        cache.recent.push_front(key);
+
+        cache.entries[key] = entry {
+            .expires  = std::chrono::steady_clock::now() + cache.ttl,
+            .result   = std::move(result),
+            .position = cache.recent.begin()
+        };
+    }
+
+    void query_cache::invalidate(const std::string& table_name) {
+        // Other sessions keep reading the committed rows until the transaction ends, and what they fetch in
+        // the meantime must not outlive the commit.
+        auto& conn = connection::get_instance();
+
+        if (conn.in_transaction()) {
+            conn.written_tables.insert(table_name);
+            return;
+        }
+
+        drop(table_name);
+    }
+
+    void query_cache::drop(const std::string& table_name) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = tables.find(table_name);
+
+        if (it == tables.end()) {
+            return;
+        }
+
+        it->second.generation++;
+        it->second.entries.clear();
+        it->second.recent.clear();
+        it->second.stats.invalidations++;
+    }
+
+    query_cache::statistics query_cache::get_statistics(const std::string& table_name) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = tables.find(table_name);
+
+        return it == tables.end() ? statistics { } : it->second.stats;
+    }
+}
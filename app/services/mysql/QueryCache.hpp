@@ -0,0 +1,91 @@
+#pragma once
+
+#include <mysql-cppconn-8/mysqlx/xdevapi.h>
+
+#include "../database/Table.hpp"
+
+#include <map>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <optional>
+
+namespace mysql {
+    // Per-table cache of select results, keyed by the normalized query. Rows are kept as raw column values
+    // and hydrated into fresh models on every hit, so cached results can be modified and saved safely.
+    // Every write through mysql::table or mysql::model drops all the entries of the table it touched, or
+    // when it was made in a transaction, once that transaction commits. Writes made outside of this
+    // process are only picked up once the entries expire. Misses are read from the primary even when replicas
+    // are configured, so rows written before the last invalidation are never cached. Each table keeps at most
+    // max_entries results, evicting expired ones first and then the least recently used.
+    class query_cache {
+    public:
+        struct rows {
+            std::vector<std::string>                columns;
+            std::vector<std::vector<mysqlx::Value>> values;
+        };
+
+        struct statistics {
+            size_t hits          = 0;
+            size_t misses        = 0;
+            size_t invalidations = 0;
+        };
+
+    private:
+        struct entry {
+            std::chrono::steady_clock::time_point expires;
+            rows                                  result;
+            std::list<std::string>::iterator      position;
+        };
+
+        struct table_cache {
+            std::chrono::milliseconds    ttl { 0 };
+            size_t                       max_entries = 0;
+            size_t                       generation  = 0;
+            std::map<std::string, entry> entries;
+            statistics                   stats;
+
+            // Keys from the most to the least recently used.
+            std::list<std::string>       recent;
+
+            void erase(std::map<std::string, entry>::iterator it);
+            void evict();
+        };
+
+        static std::mutex                         mutex;
+        static std::map<std::string, table_cache> tables;
+
+        // Number of tables with caching enabled, so queries skip the lock when there are none.
+        static std::atomic<size_t>                enabled_tables;
+
+        static void drop(const std::string& table_name);
+
+    public:
+        // Caches the results of queries against the table for ttl, keeping at most max_entries of them. A ttl
+        // of zero disables caching again.
+        static void enable (const std::string& table_name, std::chrono::milliseconds ttl, size_t max_entries = 1000);
+        static void disable(const std::string& table_name);
+
+        static bool is_enabled(const std::string& table_name);
+
+        static std::string key(const std::vector<db::where_query_t>&    wheres,
+                               const std::vector<db::order_by_query_t>& order_bys,
+                                     size_t                             limit,
+                                     size_t                             offset,
+                               const std::vector<std::string>&          columns);
+
+        // Returns the cached rows, or nothing on a miss. generation receives the value to pass to store(),
+        // so results fetched while the table was being written to are never cached.
+        static std::optional<rows> find(const std::string& table_name, const std::string& key, size_t& generation);
+
+        static void store(const std::string& table_name, const std::string& key, size_t generation, rows result);
+
+        // Drops the entries of the table, deferred to the commit when the current thread is in a transaction.
+        static void invalidate(const std::string& table_name);
+
+        static statistics get_statistics(const std::string& table_name);
+    };
+}
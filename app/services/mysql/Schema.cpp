@@ -0,0 +1,199 @@
+#include "Schema.hpp"
+#include "Connection.hpp"
+#include "QueryCache.hpp"
+#include "../tools/Format.hpp"
+
+#include <map>
+#include <regex>
+#include <cctype>
+#include <algorithm>
+
+namespace mysql {
+    std::string migration::normalize_type(std::string type) {
+        std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return std::tolower(c); });
+
+        // Collapse runs of whitespace and drop it within the parentheses.
+        type = std::regex_replace(type, std::regex("\\s+"), " ");
+        type = std::regex_replace(type, std::regex(" ?([(,]) ?| (\\))"), "$1$2");
+        type = std::regex_replace(type, std::regex("^ | $"), "");
+
+        // Aliases are stored as the type they stand for.
+        static const std::vector<std::pair<std::regex, std::string>> aliases = {
+            { std::regex("^bool(ean)?\\b"),              "tinyint(1)" },
+            { std::regex("^integer\\b"),                 "int"        },
+            { std::regex("^int1\\b"),                    "tinyint"    },
+            { std::regex("^int2\\b"),                    "smallint"   },
+            { std::regex("^(int3|middleint)\\b"),        "mediumint"  },
+            { std::regex("^int4\\b"),                    "int"        },
+            { std::regex("^int8\\b"),                    "bigint"     },
+            { std::regex("^(dec|numeric|fixed)\\b"),     "decimal"    },
+            { std::regex("^(real|double precision)\\b"), "double"     },
+            { std::regex("^character varying\\b"),       "varchar"    },
+            { std::regex("^character\\b"),               "char"       },
+        };
+
+        for (auto& [alias, canonical] : aliases) {
+            if (std::regex_search(type, alias)) {
+                type = std::regex_replace(type, alias, canonical, std::regex_constants::format_first_only);
+                break;
+            }
+        }
+
+        // Display widths of integer types are deprecated and no longer reported since MySQL 8.0.19, except
+        // for tinyint(1) which is how booleans are told apart.
+        if (!type.starts_with("tinyint(1)")) {
+            type = std::regex_replace(type, std::regex("^(tinyint|smallint|mediumint|int|bigint)\\(\\d+\\)"), "$1");
+        }
+
+        // The precision and scale of decimal default to 10 and 0.
+        type = std::regex_replace(type, std::regex("^decimal(?!\\()"),          "decimal(10,0)");
+        type = std::regex_replace(type, std::regex("^decimal\\((\\d+)\\)"), "decimal($1,0)");
+        type = std::regex_replace(type, std::regex("^year\\(4\\)"),           "year");
+
+        return type;
+    }
+
+    std::string migration::column_sql(const db::column_definition& column) const {
+        if (column.name == "id") {
+            return ::format("`id` {} NOT NULL AUTO_INCREMENT", column.type);
+        }
+
+        return ::format("`{}` {} {}", column.name, column.type, column.nullable ? "NULL" : "NOT NULL");
+    }
+
+    std::string migration::index_sql(const db::index_definition& index) const {
+        std::string columns;
+
+        for (auto& column : index.columns) {
+            columns += ::format("{}`{}`", columns.empty() ? "" : ", ", column);
+        }
+
+        return ::format("{} `{}` ({})", index.unique ? "UNIQUE INDEX" : "INDEX", index.name, columns);
+    }
+
+    void migration::create() const {
+        std::string definitions;
+
+        for (auto& column : schema.columns) {
+            definitions += ::format("{}{}", definitions.empty() ? "" : ", ", column_sql(column));
+        }
+
+        definitions += ", PRIMARY KEY (`id`)";
+
+        for (auto& index : schema.indexes) {
+            definitions += ", " + index_sql(index);
+        }
+
+        connection::get_writer().session.sql(::format("CREATE TABLE IF NOT EXISTS `{}` ({})", table_name, definitions)).execute();
+    }
+
+    void migration::destroy() const {
+        connection::get_writer().session.sql(::format("DROP TABLE IF EXISTS `{}`", table_name)).execute();
+
+        query_cache::invalidate(table_name);
+    }
+
+    std::vector<std::string> migration::plan(bool drop_columns) const {
+        auto& conn = connection::get_writer();
+
+        struct existing_column {
+            std::string type;
+            bool        nullable;
+        };
+
+        std::map<std::string, existing_column> columns;
+
+        auto column_rows = conn.session.sql("SELECT COLUMN_NAME, COLUMN_TYPE, IS_NULLABLE FROM information_schema.COLUMNS "
+                                            "WHERE TABLE_SCHEMA = ? AND TABLE_NAME = ?")
+                                       .bind(conn.get_db_name()).bind(table_name)
+                                       .execute();
+
+        for (auto row : column_rows) {
+            columns[(std::string)row[0]] = { .type = (std::string)row[1], .nullable = (std::string)row[2] == "YES" };
+        }
+
+        std::map<std::string, db::index_definition> indexes;
+
+        auto index_rows = conn.session.sql("SELECT INDEX_NAME, COLUMN_NAME, NON_UNIQUE FROM information_schema.STATISTICS "
+                                           "WHERE TABLE_SCHEMA = ? AND TABLE_NAME = ? ORDER BY INDEX_NAME, SEQ_IN_INDEX")
+                                      .bind(conn.get_db_name()).bind(table_name)
+                                      .execute();
+
+        for (auto row : index_rows) {
+            auto& index = indexes[(std::string)row[0]];
+
+            index.name   = (std::string)row[0];
+            index.unique = (int)row[2] == 0;
+            index.columns.push_back((std::string)row[1]);
+        }
+
+        std::vector<std::string> clauses;
+
+        // Indexes that change are dropped first, their columns may be modified below.
+        for (auto& [name, index] : indexes) {
+            if (name == "PRIMARY") {
+                continue;
+            }
+
+            auto declared = std::find_if(schema.indexes.begin(), schema.indexes.end(), [&name](auto& i) { return i.name == name; });
+
+            if (declared == schema.indexes.end() || declared->columns != index.columns || declared->unique != index.unique) {
+                clauses.push_back(::format("DROP INDEX `{}`", name));
+            }
+        }
+
+        for (auto& column : schema.columns) {
+            auto existing = columns.find(column.name);
+
+            if (existing == columns.end()) {
+                clauses.push_back("ADD COLUMN " + column_sql(column));
+            } else if (!column.inferred && (normalize_type(column.type) != normalize_type(existing->second.type) ||
+                                            (column.name != "id" && column.nullable != existing->second.nullable))) {
+                clauses.push_back("MODIFY COLUMN " + column_sql(column));
+            }
+        }
+
+        if (drop_columns) {
+            for (auto& [name, column] : columns) {
+                if (!schema.find_column(name)) {
+                    clauses.push_back(::format("DROP COLUMN `{}`", name));
+                }
+            }
+        }
+
+        for (auto& index : schema.indexes) {
+            auto existing = indexes.find(index.name);
+
+            if (existing == indexes.end() || existing->second.columns != index.columns || existing->second.unique != index.unique) {
+                clauses.push_back("ADD " + index_sql(index));
+            }
+        }
+
+        return clauses;
+    }
+
+    void migration::migrate(bool drop_columns) const {
+        if (!connection::get_writer().db.getTable(table_name).existsInDatabase()) {
+            create();
+
+            return;
+        }
+
+        auto clauses = plan(drop_columns);
+
+        if (clauses.empty()) {
+            return;
+        }
+
+        std::string statement;
+
+        for (auto& clause : clauses) {
+            statement += ::format("{}{}", statement.empty() ? "" : ", ", clause);
+        }
+
+        // A single ALTER TABLE lets MySQL rebuild the table at most once.
+        connection::get_writer().session.sql(::format("ALTER TABLE `{}` {}", table_name, statement)).execute();
+
+        query_cache::invalidate(table_name);
+    }
+}
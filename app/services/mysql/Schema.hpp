@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../database/Schema.hpp"
+
+#include <string>
+#include <vector>
+
+namespace mysql {
+    // Creates, drops and migrates a table from its db::schema. The "id" column is always the
+    // AUTO_INCREMENT primary key.
+    class migration {
+    private:
+        std::string table_name;
+        db::schema  schema;
+
+        std::string column_sql(const db::column_definition& column) const;
+        std::string index_sql (const db::index_definition&  index)  const;
+
+    public:
+        // Canonical spelling of a column type, so that declared types compare equal to the ones reported by
+        // information_schema: lowercase, aliases such as integer or bool resolved and integer display
+        // widths dropped, e.g. "INT(11) UNSIGNED" becomes "int unsigned".
+        static std::string normalize_type(std::string type);
+
+        migration(std::string table_name, db::schema schema) : table_name(table_name), schema(schema) { }
+
+        void create()  const;
+        void destroy() const;
+
+        // Clauses of the ALTER TABLE statement bringing the table in line with the schema, compared
+        // against information_schema. Empty when the table is up to date.
+        std::vector<std::string> plan(bool drop_columns) const;
+
+        void migrate(bool drop_columns) const;
+    };
+}
@@ -0,0 +1,90 @@
+#include "Sequence.hpp"
+#include "Connection.hpp"
+#include "../tools/Format.hpp"
+
+namespace mysql {
+    std::string sequence::sequences_table = "webcxx_sequences";
+    size_t      sequence::block_size      = 100;
+
+    sequence& sequence::get(const std::string& table_name) {
+        static std::mutex                                          mutex;
+        static std::map<std::string, std::unique_ptr<sequence>>    sequences;
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto& s = sequences[table_name];
+
+        if (!s) {
+            s.reset(new sequence(table_name));
+        }
+
+        return *s;
+    }
+
+    size_t sequence::reserve(size_t count) {
+        static std::once_flag created;
+
+        // Reserved blocks must survive a rollback of the caller's transaction, since their ids may already
+        // have been handed out, and the sequence row must not stay locked until that transaction ends.
+        auto& conn    = connection::get_autocommit();
+        auto& session = conn.session;
+
+        std::call_once(created, [&conn]() {
+            if (!conn.db.getTable(sequences_table).existsInDatabase()) {
+                conn.session.sql(::format("CREATE TABLE IF NOT EXISTS `{}` (`name` VARCHAR(64) NOT NULL PRIMARY KEY, `next_value` BIGINT UNSIGNED NOT NULL)", sequences_table)).execute();
+            }
+        });
+
+        auto update = ::format("UPDATE `{}` SET `next_value` = LAST_INSERT_ID(`next_value` + ?) WHERE `name` = ?", sequences_table);
+
+        if (session.sql(update).bind(count).bind(table_name).execute().getAffectedItemsCount() == 0) {
+            // First use of this sequence: start above the ids already in the table. Concurrent callers
+            // racing here are harmless, INSERT IGNORE keeps the first row.
+            session.sql(::format("INSERT IGNORE INTO `{}` (`name`, `next_value`) SELECT ?, COALESCE(MAX(`id`), 0) + 1 FROM `{}`", sequences_table, table_name))
+                   .bind(table_name)
+                   .execute();
+
+            session.sql(update).bind(count).bind(table_name).execute();
+        }
+
+        size_t end = session.sql("SELECT LAST_INSERT_ID();").execute().fetchOne()[0];
+
+        return end - count;
+    }
+
+    size_t sequence::next() {
+        while (true) {
+            // Fast path: take the next id of the current block.
+            if (block* b = current.load(std::memory_order_acquire)) {
+                size_t id = b->next.fetch_add(1, std::memory_order_relaxed);
+
+                if (id < b->end) {
+                    return id;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // Another thread may have refilled it while we were waiting.
+            block* b = current.load(std::memory_order_acquire);
+
+            if (b && b->next.load(std::memory_order_relaxed) < b->end) {
+                continue;
+            }
+
+            // Exhausted blocks are kept alive since other threads may still be reading them.
+            size_t first = reserve(block_size);
+
+            blocks.push_back(std::unique_ptr<block>(new block { first, first + block_size }));
+            current.store(blocks.back().get(), std::memory_order_release);
+        }
+    }
+
+    void sequence::discard() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (block* b = current.load(std::memory_order_acquire)) {
+            b->next.store(b->end, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mysql {
+    // Hi/lo id allocator. Blocks of ids are reserved from a shared sequence table with a single atomic
+    // UPDATE, then handed out locally without touching the database or taking a lock. Every model insert
+    // takes its id from here; rows written outside the models through AUTO_INCREMENT may collide with
+    // ids of a block that was already reserved.
+    class sequence {
+    private:
+        struct block {
+            std::atomic<size_t> next;
+            size_t              end;
+        };
+
+        std::string table_name;
+
+        std::atomic<block*>                 current { nullptr };
+        std::vector<std::unique_ptr<block>> blocks;
+        std::mutex                          mutex;
+
+        sequence(std::string table_name) : table_name(table_name) { }
+
+        // Reserves the next block in the database and returns its first id.
+        size_t reserve(size_t count);
+
+    public:
+        static std::string sequences_table;
+        static size_t      block_size;
+
+        static sequence& get(const std::string& table_name);
+
+        size_t next();
+
+        // Drops what is left of the current block, the next id will come from a new one.
+        void discard();
+    };
+}
@@ -5,94 +5,332 @@
 
 #include "Model.hpp"
 #include "Connection.hpp"
+#include "Sequence.hpp"
+#include "QueryCache.hpp"
+#include "Schema.hpp"
+#include "Profiler.hpp"
 #include <iostream>
+#include <algorithm>
+#include <optional>
 
 namespace mysql {
     class model;
     class joined_table;
+
+    inline mysqlx::Value serialize_column(base_property* property) {
+        mysqlx::Value column = nullptr;
+
+        property->visit([&](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+
+            if      constexpr (std::same_as<T, long long>)        column =             value;
+            else if constexpr (std::same_as<T, long double>)      column = (double)    value;
+            else if constexpr (std::same_as<T, bool>)             column =             value;
+            else if constexpr (std::same_as<T, std::string_view>) column = std::string(value);
+        });
+
+        return column;
+    }
+
+    // Types without a serialized counterpart, such as documents and raw bytes, are returned as null.
+    inline serialized to_serialized(const mysqlx::Value& value) {
+        switch (value.getType()) {
+            case mysqlx::abi2::r0::Value::Type::UINT64: return serialized { .type = serialized::integer,        .value = (ptrdiff_t)(     size_t)value };
+            case mysqlx::abi2::r0::Value::Type::INT64:  return serialized { .type = serialized::integer,        .value =            (  ptrdiff_t)value };
+            case mysqlx::abi2::r0::Value::Type::FLOAT:  return serialized { .type = serialized::floating_point, .value =            (      float)value };
+            case mysqlx::abi2::r0::Value::Type::DOUBLE: return serialized { .type = serialized::floating_point, .value =            (     double)value };
+            case mysqlx::abi2::r0::Value::Type::BOOL:   return serialized { .type = serialized::boolean,        .value =            (       bool)value };
+            case mysqlx::abi2::r0::Value::Type::STRING: return serialized { .type = serialized::string,         .value =            (std::string)value };
+            default:                                    return serialized { .type = serialized::null,           .value =                       nullptr };
+        }
+    }
+
+    inline void deserialize_column(base_property* property, const mysqlx::Value& value) {
+        auto column = to_serialized(value);
+
+        // Unsupported types leave the property untouched.
+        if (column.type != serialized::null || value.getType() == mysqlx::abi2::r0::Value::Type::VNULL) {
+            property->deserialize_value(column);
+        }
+    }
     
     template<class Model>
     class table : public db::table,
                          base_serializer {
     protected:
-        size_t next_id = 0;
-
         friend class model;
 
-        std::vector<std::shared_ptr<db::model>> get(std::vector<db::where_query_t>    wheres,
-                                                    std::vector<db::order_by_query_t> order_bys,
-                                                    size_t                            limit) const {
-            auto& session = connection::get_instance().session;
-            auto& db      = connection::get_instance().db;
-            auto  table   = db.getTable(name);
+        // MySQL rejects prepared statements with more placeholders than this.
+        static constexpr size_t max_placeholders = 65535;
+
+        std::vector<std::string> column_names(db::model& m) const {
+            std::vector<std::string> columns;
+
+            for (auto& property : get_sorted_properties(m)) {
+                columns.push_back(property.first);
+            }
+
+            return columns;
+        }
+
+        size_t rows_per_statement(size_t column_count) const {
+            return std::max<size_t>(1, std::min(batch_size, max_placeholders / std::max<size_t>(1, column_count)));
+        }
+
+        // SQL equivalent of a select, for the profiler. Without values, conditions are left as placeholders
+        // to give the shape of the query.
+        std::string select_sql(const std::vector<db::where_query_t>&    wheres,
+                               const std::vector<db::order_by_query_t>& order_bys,
+                                     size_t                             limit,
+                                     size_t                             offset,
+                               const std::vector<std::string>&          selected_columns,
+                                     bool                               with_values) const {
+            std::string projection;
+
+            for (auto& column : selected_columns) {
+                projection += std::format("{}{}", projection.empty() ? "" : ", ", column);
+            }
+
+            std::string sql = std::format("SELECT {} FROM `{}`", projection.empty() ? "*" : projection, name);
+
+            for (size_t i = 0; i < wheres.size(); i++) {
+                sql += std::format("{}{}", i == 0 ? " WHERE " : " AND ", db::to_sql(wheres[i], [&](const std::string& value) { return with_values ? value : "?"; }));
+            }
+
+            for (size_t i = 0; i < order_bys.size(); i++) {
+                sql += std::format("{}{} {}", i == 0 ? " ORDER BY " : ", ", order_bys[i].key, (order_bys[i].asc ? "ASC" : "DESC"));
+            }
+
+            if (limit != (size_t)-1 || offset != 0) {
+                sql += with_values ? std::format(" LIMIT {} OFFSET {}", limit, offset) : " LIMIT ? OFFSET ?";
+            }
+
+            return sql;
+        }
+
+        mysqlx::RowResult execute_select(connection&                              conn,
+                                         const std::vector<db::where_query_t>&    wheres,
+                                         const std::vector<db::order_by_query_t>& order_bys,
+                                         size_t                                   limit,
+                                         size_t                                   offset,
+                                         const std::vector<std::string>&          selected_columns) const {
+            auto table = conn.db.getTable(name);
 
             if (!table.existsInDatabase()) {
                 throw std::runtime_error(std::format("Cannot select models: table \"{}\" does not exist in the database.", name));
             }
 
-            std::vector<std::shared_ptr<db::model>> models;
-
-            auto select = table.select();
+            auto select = selected_columns.empty() ? table.select() : table.select(selected_columns);
 
             for (auto& condition : wheres) {
-                select = select.where(std::format("{} {} {}", condition.key, condition.query_operator, condition.value));
+                select = select.where(db::to_sql(condition));
             }
 
             for (auto& condition : order_bys) {
                 select = select.orderBy(std::format("{} {}", condition.key, (condition.asc ? "ASC" : "DESC")));
             }
 
-            auto result = select.limit(limit).execute();
-            auto& columns = result.getColumns();
+            return select.limit(limit).offset(offset).execute();
+        }
+
+        std::vector<std::shared_ptr<db::model>> get(std::vector<db::where_query_t>    wheres,
+                                                    std::vector<db::order_by_query_t> order_bys,
+                                                    size_t                            limit,
+                                                    size_t                            offset,
+                                                    std::vector<std::string>          selected_columns) const {
+            std::vector<std::shared_ptr<db::model>> models;
 
-            for(auto row : result) {
-                std::shared_ptr<db::model> m = std::make_shared<Model>();
+            get_into(wheres, order_bys, limit, offset, selected_columns, [&]() -> db::model& {
+                return *models.emplace_back(std::make_shared<Model>());
+            });
+
+            return models;
+        }
+
+        void get_into(std::vector<db::where_query_t>     wheres,
+                      std::vector<db::order_by_query_t>  order_bys,
+                      size_t                             limit,
+                      size_t                             offset,
+                      std::vector<std::string>           selected_columns,
+                      const std::function<db::model&()>& next) const {
+            // Uncommitted rows are only visible to the transaction's session and must not end up in the cache.
+            bool        cacheable  = query_cache::is_enabled(name) && !connection::transaction_open();
+            std::string key;
+            size_t      generation = 0;
+
+            if (cacheable) {
+                key = query_cache::key(wheres, order_bys, limit, offset, selected_columns);
+
+                if (auto cached = query_cache::find(name, key, generation)) {
+                    hydrate(cached->columns, cached->values, selected_columns, next);
+
+                    return;
+                }
+            }
+
+            profiler::timer timer(select_sql(wheres, order_bys, limit, offset, selected_columns, false));
+
+            std::optional<mysqlx::RowResult> executed;
+
+            auto execute = [&](connection& reader) {
+                executed.emplace(execute_select(reader, wheres, order_bys, limit, offset, selected_columns));
+            };
+
+            // A lagging replica could hand back rows the last invalidation dropped and have them cached for the
+            // whole ttl, so misses of cached queries are read from the primary.
+            auto& conn   = cacheable ? connection::get_instance() : connection::read(execute);
+
+            if (cacheable) {
+                execute(conn);
+            }
+
+            auto& result = *executed;
+
+            query_cache::rows rows;
+
+            for (auto& column : result.getColumns()) {
+                rows.columns.push_back(column.getColumnName());
+            }
+
+            size_t count;
+
+            // Rows are only copied out of the result when they are going to be cached.
+            if (cacheable) {
+                for (auto row : result) {
+                    auto& values = rows.values.emplace_back();
+
+                    for (size_t i = 0; i < rows.columns.size(); i++) {
+                        values.push_back(row.get(i));
+                    }
+                }
+
+                count = hydrate(rows.columns, rows.values, selected_columns, next);
+            } else {
+                count = hydrate(rows.columns, result, selected_columns, next);
+            }
+
+            timer.finish(count, [&] {
+                return conn.explain(select_sql(wheres, order_bys, limit, offset, selected_columns, true));
+            });
+
+            if (cacheable) {
+                query_cache::store(name, key, generation, std::move(rows));
+            }
+        }
+
+        db::column_set get_columnar(std::vector<db::where_query_t>    wheres,
+                                    std::vector<db::order_by_query_t> order_bys,
+                                    size_t                            limit,
+                                    size_t                            offset,
+                                    std::vector<std::string>          selected_columns) const {
+            profiler::timer timer(select_sql(wheres, order_bys, limit, offset, selected_columns, false));
+
+            std::optional<mysqlx::RowResult> executed;
+
+            auto& conn   = connection::read([&](connection& reader) { executed.emplace(execute_select(reader, wheres, order_bys, limit, offset, selected_columns)); });
+            auto& result = *executed;
+
+            std::vector<std::string> names;
+
+            for (auto& column : result.getColumns()) {
+                names.push_back(column.getColumnName());
+            }
+
+            db::column_set          columns(names);
+            std::vector<serialized> values(names.size());
+
+            for (auto row : result) {
+                for (size_t i = 0; i < names.size(); i++) {
+                    values[i] = to_serialized(row.get(i));
+                }
+
+                columns.push_row(values);
+            }
+
+            timer.finish(columns.size(), [&] {
+                return conn.explain(select_sql(wheres, order_bys, limit, offset, selected_columns, true));
+            });
+
+            return columns;
+        }
+
+        // Fills a model from next() for each of the rows, either cached values or a live result, and returns
+        // how many there were.
+        template<class Rows>
+        size_t hydrate(const std::vector<std::string>&    columns,
+                             Rows&                        rows,
+                       const std::vector<std::string>&    selected_columns,
+                       const std::function<db::model&()>& next) const {
+            auto   shared = share_columns(selected_columns);
+            size_t count  = 0;
+
+            for (auto&& row : rows) {
+                db::model& m = next();
+
+                if (count++ == 0 && !dynamic_cast<Model*>(&m)) {
+                    throw std::logic_error(std::format("Cannot select models: the models of table \"{}\" are of another type.", name));
+                }
 
                 // todo: change this. I hate this.
-                auto& properties = get_properties(*m);
+                auto properties = get_properties(m);
 
-                size_t i = 0;
+                set_selected_columns(m, shared);
 
-                for (auto& column : columns) {
-                    auto& value = row.get(i++);
-
-                    switch (value.getType()) {
-                        case mysqlx::abi2::r0::Value::Type::VNULL:  properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::null,           .value =                       nullptr }); break;
-                        case mysqlx::abi2::r0::Value::Type::UINT64: properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::integer,        .value = (ptrdiff_t)(     size_t)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::INT64:  properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::integer,        .value =            (  ptrdiff_t)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::FLOAT:  properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::floating_point, .value =            (      float)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::DOUBLE: properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::floating_point, .value =            (     double)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::BOOL:   properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::boolean,        .value =            (       bool)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::STRING: properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::string,         .value =            (std::string)value }); break;
+                // Columns the model doesn't declare, such as ones kept by migrate() after their property was
+                // removed, are skipped.
+                for (size_t i = 0; i < columns.size(); i++) {
+                    auto property = properties.find(columns[i]);
+
+                    if (property != properties.end()) {
+                        deserialize_column(property->second, row[i]);
                     }
                 }
 
-                models.push_back(m);
+                set_created(m);
+                m.mark_clean();
             }
 
-            return models;
+            return count;
         }
 
-        void remove(std::vector<db::where_query_t>    wheres,
-                    std::vector<db::order_by_query_t> order_bys,
-                    size_t                            limit) const {
-            auto& session = connection::get_instance().session;
-            auto& db      = connection::get_instance().db;
+        size_t remove(std::vector<db::where_query_t>    wheres,
+                      std::vector<db::order_by_query_t> order_bys,
+                      size_t                            limit) const {
+            auto& db      = connection::get_writer().db;
             auto  table   = db.getTable(name);
 
             if (!table.existsInDatabase()) {
                 throw std::runtime_error(std::format("Cannot remove models: table \"{}\" does not exist in the database.", name));
             }
 
-            std::vector<std::shared_ptr<db::model>> models;
-
             auto remove = table.remove();
 
-            for (auto& condition : wheres) {
-                remove = remove.where(std::format("{} {} {}", condition.key, condition.query_operator, condition.value));
+            std::string shape = std::format("DELETE FROM `{}`", name);
+
+            for (size_t i = 0; i < wheres.size(); i++) {
+                remove = remove.where(db::to_sql(wheres[i]));
+                shape += std::format("{}{}", i == 0 ? " WHERE " : " AND ", db::to_sql(wheres[i], [](const std::string&) { return "?"; }));
+            }
+
+            for (size_t i = 0; i < order_bys.size(); i++) {
+                remove = remove.orderBy(std::format("{} {}", order_bys[i].key, (order_bys[i].asc ? "ASC" : "DESC")));
+                shape += std::format("{}{} {}", i == 0 ? " ORDER BY " : ", ", order_bys[i].key, (order_bys[i].asc ? "ASC" : "DESC"));
+            }
+
+            if (limit != (size_t)-1) {
+                remove = remove.limit(limit);
+                shape += " LIMIT ?";
             }
 
-            remove.limit(limit).execute();
+            profiler::timer timer(shape);
+
+            size_t removed = remove.execute().getAffectedItemsCount();
+
+            timer.finish(removed);
+
+            query_cache::invalidate(name);
+
+            return removed;
         }
 
         std::shared_ptr<db::joined_table> join(const base_table& that,
@@ -103,6 +341,21 @@ namespace mysql {
         }
 
     public:
+        using model_type = Model;
+        using db::base_table::join;
+
+        // Maximum number of rows sent in a single statement by the batch operations.
+        size_t batch_size = 1000;
+
+        // Caches the results of up to max_entries queries against this table for ttl, see mysql::query_cache.
+        void cache(std::chrono::milliseconds ttl, size_t max_entries = 1000) const {
+            query_cache::enable(name, ttl, max_entries);
+        }
+
+        query_cache::statistics cache_statistics() const {
+            return query_cache::get_statistics(name);
+        }
+
         table() : db::table(Model { }) { };
         table(const table& ) = default;
         table(      table&&) = default;
@@ -110,177 +363,535 @@ namespace mysql {
         table& operator=(const table& ) = default;
         table& operator=(      table&&) = default;
         
+        // Inserts the models with as few statements as possible. Models without an id get the next one of the
+        // table's sequence, the same as model::save(), so keyed and new models can share a statement.
         void insert(std::vector<std::shared_ptr<db::model>> models) {
-            auto& session = connection::get_instance().session;
-            auto& db      = connection::get_instance().db;
-            auto  table   = db.getTable(name);
+            auto table = connection::get_writer().db.getTable(name);
 
             if (!table.existsInDatabase()) {
                 throw std::runtime_error(std::format("Cannot insert models: table \"{}\" does not exist in the database.", name));
             }
 
-            std::vector<mysqlx::abi2::Row> rows;
-
-            auto insert_statement = table.insert();
+            if (models.empty()) {
+                return;
+            }
 
             for (auto& model : models) {
-                mysqlx::abi2::Row row;
-                
-                size_t index = 0;
-
-                for(auto& property : get_sorted_properties(*model)) {
-                    auto value = property.second->serialize_value();
-
-                    switch(value.type) {
-                        case serialized::integer:        row.set(index++,         std::get<long long     >(value.value)); break;
-                        case serialized::floating_point: row.set(index++, (double)std::get<long double   >(value.value)); break;
-                        case serialized::boolean:        row.set(index++,         std::get<bool          >(value.value)); break;
-                        case serialized::null:           row.set(index++,         std::get<std::nullptr_t>(value.value)); break;
-                        case serialized::string:         row.set(index++,         std::get<std::string   >(value.value)); break;
+                if (model->id == 0) {
+                    model->id = get_next_id();
+                }
+            }
+
+            auto   columns = column_names(*models.front());
+            size_t chunk   = rows_per_statement(columns.size());
+
+            for (size_t first = 0; first < models.size(); first += chunk) {
+                size_t last             = std::min(first + chunk, models.size());
+                auto   insert_statement = table.insert(columns);
+
+                for (size_t i = first; i < last; i++) {
+                    mysqlx::abi2::Row row;
+
+                    size_t index = 0;
+
+                    for (auto& property : get_sorted_properties(*models[i])) {
+                        row.set(index++, serialize_column(property.second));
                     }
+
+                    insert_statement = insert_statement.values(row);
                 }
 
-                model->id = get_next_id();
+                profiler::timer timer(std::format("INSERT INTO `{}` ({} columns) VALUES ...", name, columns.size()));
+
+                insert_statement.execute();
+
+                timer.finish(last - first);
 
-                insert_statement = insert_statement.values(row);
+                for (size_t i = first; i < last; i++) {
+                    set_created(*models[i]);
+                    models[i]->mark_clean();
+                }
             }
 
-            insert_statement.execute();
+            query_cache::invalidate(name);
+        }
 
-            size_t last = session.sql("SELECT LAST_INSERT_ID();").execute().fetchOne()[0];
+        // Inserts the models, or updates the existing rows when they collide on the primary key or a unique
+        // index, sending up to batch_size rows per INSERT ... ON DUPLICATE KEY UPDATE. Models without an id
+        // cannot collide on the primary key and are inserted through insert().
+        void upsert(std::vector<std::shared_ptr<db::model>> models) {
+            auto& session = connection::get_writer().session;
 
-            size_t i = 1;
+            std::vector<std::shared_ptr<db::model>> keyed;
+            std::vector<std::shared_ptr<db::model>> unkeyed;
 
             for (auto& model : models) {
-                if (model->id == 0) {
-                    model->id = last - models.size() + (i++);
-                } else i++;
+                (model->id == 0 ? unkeyed : keyed).push_back(model);
+            }
+
+            insert(unkeyed);
+
+            if (keyed.empty()) {
+                return;
+            }
+
+            auto   columns = column_names(*keyed.front());
+            size_t chunk   = rows_per_statement(columns.size());
+
+            std::string column_list;
+            std::string placeholders;
+            std::string assignments;
+
+            for (auto& column : columns) {
+                column_list  += std::format("{}`{}`", column_list.empty()  ? "" : ", ", column);
+                placeholders += std::format("{}?",    placeholders.empty() ? "" : ", ");
+
+                if (column != "id") {
+                    assignments += std::format("{}`{}` = new.`{}`", assignments.empty() ? "" : ", ", column, column);
+                }
+            }
+
+            for (size_t first = 0; first < keyed.size(); first += chunk) {
+                size_t last = std::min(first + chunk, keyed.size());
+
+                std::string rows;
+
+                for (size_t i = first; i < last; i++) {
+                    rows += std::format("{}({})", rows.empty() ? "" : ", ", placeholders);
+                }
+
+                auto statement = session.sql(std::format("INSERT INTO `{}` ({}) VALUES {} AS new ON DUPLICATE KEY UPDATE {}",
+                                                         name, column_list, rows, assignments.empty() ? "`id` = new.`id`" : assignments));
+
+                for (size_t i = first; i < last; i++) {
+                    for (auto& property : get_sorted_properties(*keyed[i])) {
+                        statement.bind(serialize_column(property.second));
+                    }
+                }
+
+                profiler::timer timer(std::format("INSERT INTO `{}` ({} columns) VALUES ... ON DUPLICATE KEY UPDATE", name, columns.size()));
+
+                timer.finish(statement.execute().getAffectedItemsCount());
+
+                for (size_t i = first; i < last; i++) {
+                    set_created(*keyed[i]);
+                    keyed[i]->mark_clean();
+                }
+            }
+
+            query_cache::invalidate(name);
+        }
+
+        // Updates existing rows with a single UPDATE ... SET column = CASE id ... per batch_size models,
+        // instead of one statement per model. Only the columns that changed on each model are written.
+        void update(std::vector<std::shared_ptr<db::model>> models) {
+            auto& session = connection::get_writer().session;
+
+            if (models.empty()) {
+                return;
+            }
+
+            auto   columns = column_names(*models.front());
+            size_t chunk   = std::max<size_t>(1, std::min(batch_size, max_placeholders / (2 * columns.size() + 1)));
+
+            for (size_t first = 0; first < models.size(); first += chunk) {
+                size_t last = std::min(first + chunk, models.size());
+
+                std::string                assignments;
+                std::string                assigned_columns;
+                std::vector<mysqlx::Value> values;
+
+                for (auto& column : columns) {
+                    if (column == "id") {
+                        continue;
+                    }
+
+                    std::string cases;
+
+                    for (size_t i = first; i < last; i++) {
+                        if (!get_properties(*models[i])[column]->is_dirty()) {
+                            continue;
+                        }
+
+                        cases += " WHEN ? THEN ?";
+
+                        values.push_back((size_t)models[i]->id);
+                        values.push_back(serialize_column(get_properties(*models[i])[column]));
+                    }
+
+                    if (!cases.empty()) {
+                        assignments      += std::format("{}`{}` = CASE `id`{} ELSE `{}` END", assignments.empty() ? "" : ", ", column, cases, column);
+                        assigned_columns += std::format("{}`{}` = CASE ...", assigned_columns.empty() ? "" : ", ", column);
+                    }
+                }
+
+                if (assignments.empty()) {
+                    continue;
+                }
+
+                std::string ids;
+
+                for (size_t i = first; i < last; i++) {
+                    ids += ids.empty() ? "?" : ", ?";
+                    values.push_back((size_t)models[i]->id);
+                }
+
+                auto statement = session.sql(std::format("UPDATE `{}` SET {} WHERE `id` IN ({})", name, assignments, ids));
+
+                for (auto& value : values) {
+                    statement.bind(value);
+                }
+
+                profiler::timer timer(std::format("UPDATE `{}` SET {} WHERE `id` IN (...)", name, assigned_columns));
+
+                timer.finish(statement.execute().getAffectedItemsCount());
+
+                for (size_t i = first; i < last; i++) {
+                    models[i]->mark_clean();
+                }
             }
+
+            query_cache::invalidate(name);
         }
 
         void remove(std::vector<std::shared_ptr<db::model>> models) const {
-            auto& session = connection::get_instance().session;
-            auto& db      = connection::get_instance().db;
+            auto& session = connection::get_writer().session;
+            auto& db      = connection::get_writer().db;
             auto  table   = db.getTable(name);
 
             if (!table.existsInDatabase()) {
                 throw std::runtime_error(std::format("Cannot remove models: table \"{}\" does not exist in the database.", name));
             }
 
-            std::string condition = "";
-            size_t i = 0;
+            // Ids are bound rather than inlined, batch_size at a time, so the statements stay well below
+            // max_allowed_packet however many models are removed. Every chunk commits on its own unless a
+            // transaction is open.
+            size_t chunk = rows_per_statement(1);
 
-            for (auto& model : models) {
-                if (!condition.empty()) {
-                    condition += ",";
+            for (size_t first = 0; first < models.size(); first += chunk) {
+                size_t last = std::min(first + chunk, models.size());
+
+                std::string placeholders;
+
+                for (size_t i = first; i < last; i++) {
+                    placeholders += placeholders.empty() ? "?" : ", ?";
+                }
+
+                auto statement = session.sql(std::format("DELETE FROM `{}` WHERE `id` IN ({})", name, placeholders));
+
+                for (size_t i = first; i < last; i++) {
+                    statement.bind((size_t)models[i]->id);
+                }
+
+                profiler::timer timer(std::format("DELETE FROM `{}` WHERE `id` IN (...)", name));
+
+                timer.finish(statement.execute().getAffectedItemsCount());
+            }
+
+            query_cache::invalidate(name);
+        }
+
+        // The model's declared schema, completed with types inferred from the properties it left out.
+        db::schema get_schema() const {
+            Model m;
+            db::schema s;
+
+            m.define_schema(s);
+
+            db::schema complete;
+
+            complete.indexes = s.indexes;
+
+            for (auto& property : get_sorted_properties(m)) {
+                if (auto declared = s.find_column(property.first)) {
+                    complete.columns.push_back(*declared);
+
+                    continue;
+                }
+
+                std::string type;
+
+                if (property.first == "id") {
+                    type = "bigint unsigned";
+                } else switch (property.second->serialized_type()) {
+                    case serialized::integer:        type = "bigint";       break;
+                    case serialized::floating_point: type = "double";       break;
+                    case serialized::boolean:        type = "tinyint(1)";   break;
+                    case serialized::string:         type = "varchar(255)"; break;
+
+                    // Nested models are not stored in a column.
+                    default: continue;
                 }
 
-                condition += std::to_string((size_t)model->id);
+                complete.columns.push_back({ .name = property.first, .type = type, .inferred = true });
             }
 
-            table.remove().where("id IN [" + condition + "]").execute();
+            return complete;
         }
 
         void create() const {
-            // todo
+            migration(name, get_schema()).create();
         }
 
         void destroy() const {
-            // todo
+            migration(name, get_schema()).destroy();
+        }
+
+        void migrate(bool drop_columns = false) const {
+            migration(name, get_schema()).migrate(drop_columns);
         }
 
         void clear() const {
-            auto& session = connection::get_instance().session;
-            auto& db      = connection::get_instance().db;
+            auto& session = connection::get_writer().session;
+            auto& db      = connection::get_writer().db;
             auto  table   = db.getTable(name);
 
             if (!table.existsInDatabase()) {
                 throw std::runtime_error(std::format("Cannot remove models: table \"{}\" does not exist in the database.", name));
             }
 
-            table.remove().where("id > 0").execute();
+            profiler::timer timer(std::format("DELETE FROM `{}` WHERE `id` > 0", name));
+
+            timer.finish(table.remove().where("id > 0").execute().getAffectedItemsCount());
+
+            query_cache::invalidate(name);
         }
 
+        std::shared_ptr<db::model> new_model() const {
+            return std::make_shared<Model>();
+        }
+
+        std::shared_ptr<const db::base_table> copy() const {
+            return std::make_shared<table>(*this);
+        }
+
+        // Hands out an id ahead of inserting the model, from a block reserved through mysql::sequence.
         size_t get_next_id(bool force_update = false) {
-            if (next_id == 0 || force_update)
-            {
-                auto& session = connection::get_instance().session;
-                auto& db      = connection::get_instance().db;
-                auto  table   = db.getTable(name);
-
-                try {
-                    next_id = table.select("MAX(id)").execute().fetchOne().get(0);
-                } catch(mysqlx::abi2::r0::Error& e) {
-                    next_id = 0;
-                }
+            auto& ids = sequence::get(name);
+
+            if (force_update) {
+                ids.discard();
             }
 
-            return ++next_id;
+            return ids.next();
         }
     };
 
-    class joined_table : public db::joined_table {
+    class joined_table : public db::joined_table,
+                                base_serializer {
+    private:
+        static std::string join_keyword(db::join_mode_t mode) {
+            switch (mode) {
+                case db::join_mode_t::inner: return "INNER JOIN";
+                case db::join_mode_t::left:  return "LEFT JOIN";
+                case db::join_mode_t::right: return "RIGHT JOIN";
+                case db::join_mode_t::outer: break;
+            }
+
+            throw std::runtime_error("Cannot join tables: MySQL does not support FULL OUTER JOIN.");
+        }
+
+        // Keys without a table name are resolved against the table on their side of the join.
+        static std::string qualify(const db::base_table* t, const std::string& key) {
+            if (key.find('.') != key.npos) {
+                return key;
+            }
+
+            if (as_joined(t)) {
+                throw std::runtime_error(std::format("Cannot join tables: key \"{}\" is ambiguous, prefix it with its table name.", key));
+            }
+
+            return std::format("`{}`.{}", t->get_name(), key);
+        }
+
+        static std::string table_reference(const db::base_table* t) {
+            if (!as_joined(t)) {
+                return std::format("`{}`", t->get_name());
+            }
+
+            auto nested = dynamic_cast<const joined_table*>(t);
+
+            if (!nested) {
+                throw std::runtime_error("Cannot join tables: all joined tables must belong to the same database.");
+            }
+
+            return std::format("({})", nested->join_clause());
+        }
+
+        // Without values, conditions are left as placeholders to give the shape of the query to the profiler.
+        static std::string where_clause(const std::vector<db::where_query_t>& wheres, bool with_values = true) {
+            std::string clause;
+
+            for (auto& condition : wheres) {
+                clause += std::format("{}{}", clause.empty() ? " WHERE " : " AND ", db::to_sql(condition, [&](const std::string& value) { return with_values ? value : "?"; }));
+            }
+
+            return clause;
+        }
+
+        std::string join_clause() const {
+            auto& join = root();
+
+            return std::format("{} {} {} ON {} = {}",
+                               table_reference(join.this_table),
+                               join_keyword(join.mode),
+                               table_reference(join.that_table),
+                               qualify(join.this_table, join.this_key),
+                               qualify(join.that_table, join.that_key));
+        }
+
     protected:
+        // Runs as a single SELECT ... JOIN and splits every row back into one model per table.
         std::vector<std::shared_ptr<db::model>> get(std::vector<db::where_query_t>    wheres,
                                                     std::vector<db::order_by_query_t> order_bys,
-                                                    size_t                            limit) const {
-            /* auto& session = connection::get_instance().session;
-            auto& db      = connection::get_instance().db;
-            auto  table   = db.getTable(name);
+                                                    size_t                            limit,
+                                                    size_t                            offset,
+                                                    std::vector<std::string>          selected_columns) const {
+            auto tables = get_tables();
 
-            if (!table.existsInDatabase()) {
-                throw std::runtime_error(std::format("Cannot select models: table \"{}\" does not exist in the database.", name));
-            }
+            std::string projection;
 
-            std::vector<std::shared_ptr<db::model>> models;
+            if (selected_columns.empty()) {
+                for (auto t : tables) {
+                    projection += std::format("{}`{}`.*", projection.empty() ? "" : ", ", t->get_name());
+                }
+            } else {
+                for (auto& column : selected_columns) {
+                    // select() always adds "id", which is ambiguous here: fetch the id of every table instead.
+                    if (column == "id") {
+                        for (auto t : tables) {
+                            projection += std::format("{}`{}`.id", projection.empty() ? "" : ", ", t->get_name());
+                        }
+                    } else {
+                        projection += std::format("{}{}", projection.empty() ? "" : ", ", column);
+                    }
+                }
+            }
 
-            auto select = table.select();
+            std::string order;
 
-            for (auto& condition : wheres) {
-                select = select.where(std::format("{} {} {}", condition.key, condition.query_operator, condition.value));
+            for (size_t i = 0; i < order_bys.size(); i++) {
+                order += std::format("{}{} {}", i == 0 ? " ORDER BY " : ", ", order_bys[i].key, (order_bys[i].asc ? "ASC" : "DESC"));
             }
 
-            for (auto& condition : order_bys) {
-                select = select.orderBy(std::format("{} {}", condition.key, (condition.asc ? "ASC" : "DESC")));
+            std::string sql   = std::format("SELECT {} FROM {}{}{}", projection, join_clause(), where_clause(wheres),        order);
+            std::string shape = std::format("SELECT {} FROM {}{}{}", projection, join_clause(), where_clause(wheres, false), order);
+
+            if (limit != (size_t)-1 || offset != 0) {
+                sql   += std::format(" LIMIT {} OFFSET {}", limit, offset);
+                shape += " LIMIT ? OFFSET ?";
             }
 
-            auto result = select.limit(limit).execute();
+            profiler::timer timer(shape);
+
+            std::optional<mysqlx::SqlResult> executed;
+
+            auto& conn    = connection::read([&](connection& reader) { executed.emplace(reader.session.sql(sql).execute()); });
+            auto& result  = *executed;
             auto& columns = result.getColumns();
 
-            for(auto row : result) {
-                std::shared_ptr<db::model> m = std::make_shared<Model>();
+            // Index of the table every column belongs to, or -1 for computed columns.
+            std::vector<size_t>                   owners;
+            std::vector<std::vector<std::string>> loaded_columns(tables.size());
 
-                // todo: change this. I hate this.
-                auto& properties = get_properties(*m);
+            for (size_t i = 0; i < columns.size(); i++) {
+                std::string table_label = std::string(columns[i].getTableLabel());
+                size_t      owner       = (size_t)-1;
 
-                size_t i = 0;
+                for (size_t j = 0; j < tables.size(); j++) {
+                    if (tables[j]->get_name() == table_label) {
+                        owner = j;
+                        loaded_columns[j].push_back(std::string(columns[i].getColumnName()));
+                        break;
+                    }
+                }
 
-                for (auto& column : columns) {
-                    auto& value = row.get(i++);
-
-                    switch (value.getType()) {
-                        case mysqlx::abi2::r0::Value::Type::VNULL:  properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::null,           .value =                       nullptr }); break;
-                        case mysqlx::abi2::r0::Value::Type::UINT64: properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::integer,        .value = (ptrdiff_t)(     size_t)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::INT64:  properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::integer,        .value =            (  ptrdiff_t)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::FLOAT:  properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::floating_point, .value =            (      float)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::DOUBLE: properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::floating_point, .value =            (     double)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::BOOL:   properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::boolean,        .value =            (       bool)value }); break;
-                        case mysqlx::abi2::r0::Value::Type::STRING: properties[column.getColumnName()]->deserialize_value(serialized { .type = serialized::string,         .value =            (std::string)value }); break;
+                owners.push_back(owner);
+            }
+
+            std::vector<std::shared_ptr<const std::vector<std::string>>> shared_columns;
+
+            for (auto& loaded : loaded_columns) {
+                shared_columns.push_back(std::make_shared<const std::vector<std::string>>(std::move(loaded)));
+            }
+
+            std::vector<std::shared_ptr<db::model>> models;
+
+            for (auto row : result) {
+                std::vector<std::shared_ptr<db::model>> row_models(tables.size());
+
+                // An unmatched table in a left or right join only has NULL columns and gets no model.
+                for (size_t i = 0; i < columns.size(); i++) {
+                    if (owners[i] != (size_t)-1 && !row_models[owners[i]] && row.get(i).getType() != mysqlx::abi2::r0::Value::Type::VNULL) {
+                        row_models[owners[i]] = tables[owners[i]]->new_model();
+                    }
+                }
+
+                for (size_t i = 0; i < columns.size(); i++) {
+                    if (owners[i] == (size_t)-1 || !row_models[owners[i]]) {
+                        continue;
+                    }
+
+                    auto  properties = get_properties(*row_models[owners[i]]);
+                    auto  property   = properties.find(std::string(columns[i].getColumnName()));
+
+                    if (property != properties.end()) {
+                        deserialize_column(property->second, row.get(i));
+                    }
+                }
+
+                for (auto& m : row_models) {
+                    if (m) {
+                        set_created(*m);
+                        m->mark_clean();
                     }
                 }
 
-                models.push_back(m);
+                if (!selected_columns.empty()) {
+                    for (size_t j = 0; j < tables.size(); j++) {
+                        if (row_models[j]) {
+                            set_selected_columns(*row_models[j], shared_columns[j]);
+                        }
+                    }
+                }
+
+                models.push_back(std::make_shared<db::joined_model>(row_models));
             }
 
-            return models; */
+            timer.finish(models.size(), [&] {
+                return conn.explain(sql);
+            });
 
-            return { };
+            return models;
         }
 
-        void remove(std::vector<db::where_query_t>    wheres,
-                    std::vector<db::order_by_query_t> order_bys,
-                    size_t                            limit) const {
-            // todo
+        // Removes the matching rows from every joined table.
+        size_t remove(std::vector<db::where_query_t>    wheres,
+                      std::vector<db::order_by_query_t> order_bys,
+                      size_t                            limit) const {
+            if (!order_bys.empty() || limit != (size_t)-1) {
+                throw std::runtime_error("Cannot remove joined models: MySQL does not support ORDER BY or LIMIT in multiple-table deletes.");
+            }
+
+            auto& session = connection::get_writer().session;
+
+            std::string targets;
+
+            for (auto t : get_tables()) {
+                targets += std::format("{}`{}`", targets.empty() ? "" : ", ", t->get_name());
+            }
+
+            profiler::timer timer(std::format("DELETE {} FROM {}{}", targets, join_clause(), where_clause(wheres, false)));
+
+            size_t removed = session.sql(std::format("DELETE {} FROM {}{}", targets, join_clause(), where_clause(wheres))).execute().getAffectedItemsCount();
+
+            timer.finish(removed);
+
+            for (auto t : get_tables()) {
+                query_cache::invalidate(t->get_name());
+            }
+
+            return removed;
         }
 
         std::shared_ptr<db::joined_table> join(const base_table& that,
@@ -290,9 +901,9 @@ namespace mysql {
             return std::make_shared<joined_table>(this, &that, this_key, that_key, mode);
         }
 
-        bool joined = false;
-
     public:
+        using db::base_table::join;
+
         joined_table(const base_table* this_table,
                      const base_table* that_table,
                            std::string this_key,
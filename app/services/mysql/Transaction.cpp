@@ -1,30 +1,71 @@
+#include "Connection.hpp"
 #include "Transaction.hpp"
+#include "QueryCache.hpp"
+#include "../tools/Format.hpp"
+
+#include <utility>
+#include <stdexcept>
 
 namespace mysql {
-    std::mutex transaction::mutex;
+    // Reads are pinned to the primary while a transaction is open, see connection::get_reader().
+    transaction::transaction(connection& conn) : conn(conn), session(conn.session), level(conn.transactions + 1) {
+        if (level == 1) {
+            session.startTransaction();
+        } else {
+            savepoint = ::format("webcxx_savepoint_{}", level);
+            session.setSavepoint(savepoint);
+        }
 
-    transaction::transaction(connection& conn) : session(conn.session) {
-        mutex.lock();
-        session.startTransaction();
+        conn.transactions++;
     }
 
     transaction::~transaction() {
-        if (!unlocked) {
-            mutex.unlock();
+        if (finished) {
+            return;
         }
+
+        // Destructors must not throw, the connection is left as is if the rollback fails.
+        try {
+            rollback();
+        } catch (std::exception& e) { }
+    }
+
+    void transaction::finish(const char* action) {
+        if (finished) {
+            throw std::logic_error(::format("Cannot {} transaction: it has already ended.", action));
+        }
+
+        if (conn.transactions != level) {
+            throw std::logic_error(::format("Cannot {} transaction: a nested transaction is still open.", action));
+        }
+
+        finished = true;
+        conn.transactions--;
     }
 
     void transaction::commit() {
-        session.commit();
+        finish("commit");
+
+        if (level == 1) {
+            session.commit();
 
-        unlocked = true;
-        mutex.unlock();
+            for (auto& table_name : std::exchange(conn.written_tables, { })) {
+                query_cache::invalidate(table_name);
+            }
+        } else {
+            session.releaseSavepoint(savepoint);
+        }
     }
 
     void transaction::rollback() {
-        session.rollback();
+        finish("roll back");
+
+        if (level == 1) {
+            session.rollback();
 
-        unlocked = true;
-        mutex.unlock();
+            conn.written_tables.clear();
+        } else {
+            session.rollbackTo(savepoint);
+        }
     }
 }
@@ -1,31 +1,40 @@
 #pragma once
 
 #include <mysql-cppconn-8/mysqlx/xdevapi.h>
-#include <mutex>
+#include <string>
 
 #include "../database/Transaction.hpp"
 
 namespace mysql {
     class connection;
 
+    // Transaction on a single connection. Transactions begun while another one is open on the same
+    // connection are nested and run as savepoints, so they can be rolled back on their own. A
+    // transaction that is neither committed nor rolled back when it goes out of scope, e.g. because an
+    // exception was thrown, is rolled back.
     class transaction : db::transaction {
     private:
         friend class connection;
 
         transaction(connection& conn);
 
+        connection&      conn;
         mysqlx::Session& session;
-        bool unlocked = false;
 
-        static std::mutex mutex;
+        // 1 for the outermost transaction.
+        size_t      level;
+        std::string savepoint;
+        bool        finished = false;
+
+        void finish(const char* action);
 
     public:
-        ~transaction();
+        transaction(const transaction& ) = delete;
+        transaction(      transaction&&) = delete;
 
+        ~transaction();
 
         void commit();
         void rollback();
     };
 }
-
-#include "Connection.hpp"
@@ -0,0 +1,227 @@
+#include "Batch.hpp"
+#include "Handle.hpp"
+
+#include <chrono>
+#include <optional>
+#include <algorithm>
+
+namespace rest {
+    struct batch::transfer {
+        CURL*                  curl;
+        request                r;
+        sender                 from;
+        receiver               into;
+        header_list            headers;
+        std::promise<response> promise;
+        std::string            origin;
+        size_t                 attempt = 1;
+
+        // Held while the transfer is running, see circuit_breaker::permit.
+        std::optional<circuit_breaker::permit> permit;
+
+        // When a failed transfer waiting for its retry may start again.
+        std::chrono::steady_clock::time_point retry_at;
+
+        transfer(request r) :
+            curl(curl_easy_init()),
+            r(std::move(r)),
+            headers(this->r.headers),
+            origin(handle::origin_of(this->r.u.native())) { }
+
+        ~transfer() { curl_easy_cleanup(curl); }
+    };
+
+    long batch::max_host_connections = 8;
+
+    // One multi handle per thread, so its connection cache outlives a single batch.
+    static CURLM* get_multi() {
+        thread_local struct multi {
+            CURLM* instance;
+
+             multi() : instance(curl_multi_init()) { curl_multi_setopt(instance, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX); }
+            ~multi()                                { curl_multi_cleanup(instance); }
+        } m;
+
+        curl_multi_setopt(m.instance, CURLMOPT_MAX_HOST_CONNECTIONS, batch::max_host_connections);
+
+        return m.instance;
+    }
+
+    batch::batch() = default;
+    batch::~batch() = default;
+
+    std::future<response> batch::add(request r) {
+        auto t = std::make_unique<transfer>(std::move(r));
+
+        if (!t->curl) {
+            throw rest_error("Failed to initialize CURL connection.");
+        }
+
+        auto future = t->promise.get_future();
+
+        transfers.push_back(std::move(t));
+
+        return future;
+    }
+
+    std::future<response> batch::get(const url& u, std::vector<header> headers) {
+        return add({ .method = "GET", .u = u, .headers = std::move(headers) });
+    }
+
+    std::future<response> batch::head(const url& u, std::vector<header> headers) {
+        return add({ .method = "HEAD", .u = u, .headers = std::move(headers) });
+    }
+
+    std::future<response> batch::post(const url& u, std::string data, std::vector<header> headers) {
+        return add({ .method = "POST", .u = u, .body = std::move(data), .headers = std::move(headers) });
+    }
+
+    std::future<response> batch::post(const url& u, json data, std::vector<header> headers) {
+        return post(u, (std::string)data, std::move(headers));
+    }
+
+    std::future<response> batch::post(const url& u, const char* data, std::vector<header> headers) {
+        return post(u, std::string(data), std::move(headers));
+    }
+
+    std::future<response> batch::put(const url& u, std::string data, std::vector<header> headers) {
+        return add({ .method = "PUT", .u = u, .body = std::move(data), .headers = std::move(headers) });
+    }
+
+    std::future<response> batch::put(const url& u, json data, std::vector<header> headers) {
+        return put(u, (std::string)data, std::move(headers));
+    }
+
+    std::future<response> batch::put(const url& u, const char* data, std::vector<header> headers) {
+        return put(u, std::string(data), std::move(headers));
+    }
+
+    std::future<response> batch::patch(const url& u, std::string data, std::vector<header> headers) {
+        return add({ .method = "PATCH", .u = u, .body = std::move(data), .headers = std::move(headers) });
+    }
+
+    std::future<response> batch::patch(const url& u, json data, std::vector<header> headers) {
+        return patch(u, (std::string)data, std::move(headers));
+    }
+
+    std::future<response> batch::patch(const url& u, const char* data, std::vector<header> headers) {
+        return patch(u, std::string(data), std::move(headers));
+    }
+
+    std::future<response> batch::do_delete(const url& u, std::vector<header> headers) {
+        return add({ .method = "DELETE", .u = u, .headers = std::move(headers) });
+    }
+
+    void batch::run() {
+        using clock = std::chrono::steady_clock;
+
+        CURLM* multi   = get_multi();
+        auto   pending = std::move(transfers);
+
+        transfers.clear();
+
+        std::vector<transfer*> waiting;
+        int                    running = 0;
+
+        auto start = [&](transfer& t) {
+            try {
+                t.permit = circuit_breaker::allow(t.origin);
+            } catch (rest_error&) {
+                t.promise.set_exception(std::current_exception());
+
+                return;
+            }
+
+            t.into.res.data.clear();
+
+            curl_multi_add_handle(multi, t.curl);
+
+            running++;
+        };
+
+        for (auto& t : pending) {
+            handle::configure(t->curl);
+            prepare(t->curl, t->r, t->from, t->into, t->headers);
+
+            // Wait for a TLS connection to the host to negotiate HTTP/2 and multiplex on it, rather than opening
+            // another one. Plain HTTP never multiplexes, waiting would only serialize the requests.
+            if (t->r.u.protocol() == "https") {
+                curl_easy_setopt(t->curl, CURLOPT_PIPEWAIT, 1L);
+            }
+
+            start(*t);
+        }
+
+        while (running > 0 || !waiting.empty()) {
+            auto now = clock::now();
+
+            for (auto it = waiting.begin(); it != waiting.end();) {
+                if ((*it)->retry_at <= now) {
+                    start(**it);
+
+                    it = waiting.erase(it);
+                } else {
+                    it++;
+                }
+            }
+
+            CURLMcode mc = curl_multi_perform(multi, &running);
+
+            // Sleep until a transfer has progressed or the next retry is due.
+            int timeout_ms = 1000;
+
+            for (auto t : waiting) {
+                timeout_ms = std::clamp((int)std::chrono::duration_cast<std::chrono::milliseconds>(t->retry_at - now).count(), 0, timeout_ms);
+            }
+
+            if (mc == CURLM_OK && (running > 0 || !waiting.empty())) {
+                mc = curl_multi_poll(multi, nullptr, 0, timeout_ms, nullptr);
+            }
+
+            if (mc != CURLM_OK) {
+                for (auto& t : pending) {
+                    curl_multi_remove_handle(multi, t->curl);
+                }
+
+                throw rest_error("Failed to send requests: " + std::string(curl_multi_strerror(mc)));
+            }
+
+            int      queued;
+            CURLMsg* message;
+
+            while ((message = curl_multi_info_read(multi, &queued))) {
+                if (message->msg != CURLMSG_DONE) {
+                    continue;
+                }
+
+                auto& t = *std::find_if(pending.begin(), pending.end(), [&](auto& t) { return t->curl == message->easy_handle; });
+
+                CURLcode ec          = message->data.result;
+                long     status_code = 0;
+
+                curl_easy_getinfo(t->curl, CURLINFO_RESPONSE_CODE, &status_code);
+                curl_multi_remove_handle(multi, t->curl);
+
+                // An exception from a callback is the caller's, not a failure of the upstream.
+                if (!t->into.error && !t->from.error) {
+                    t->permit->record(ec == CURLE_OK && status_code < 500);
+                }
+
+                t->permit.reset();
+
+                if (retryable(t->r, ec, status_code, t->attempt, t->from, t->into)) {
+                    t->attempt++;
+                    t->retry_at = clock::now() + t->r.retry.delay(t->attempt);
+
+                    waiting.push_back(t.get());
+                } else {
+                    try {
+                        t->promise.set_value(finish(t->r, ec, status_code, t->from, t->into));
+                    } catch (...) {
+                        t->promise.set_exception(std::current_exception());
+                    }
+                }
+            }
+        }
+    }
+}
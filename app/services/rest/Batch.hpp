@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Rest.hpp"
+
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace rest {
+    // Sends several requests concurrently, so fanning out to several APIs takes as long as the slowest call
+    // rather than the sum of them:
+    //
+    //     rest::batch b;
+    //
+    //     auto users  = b.get("https://users.example.com/1");
+    //     auto orders = b.get("https://orders.example.com/?user=1");
+    //
+    //     b.run();
+    //
+    //     auto u = users.get();
+    //
+    // The futures are ready once run() returns. Failed requests hold a rest_error.
+    class batch {
+    private:
+        struct transfer;
+
+        std::vector<std::unique_ptr<transfer>> transfers;
+
+    public:
+        batch();
+        ~batch();
+
+        batch(const batch& ) = delete;
+        batch(      batch&&) = default;
+
+        // Connections kept open per host by each thread. HTTP/2 requests to the same host share a connection.
+        static long max_host_connections;
+
+        std::future<response> add(request r);
+
+        std::future<response>       get(const url& u,                   std::vector<header> headers = { });
+        std::future<response>      head(const url& u,                   std::vector<header> headers = { });
+        std::future<response>      post(const url& u, std::string data, std::vector<header> headers = { });
+        std::future<response>      post(const url& u,        json data, std::vector<header> headers = { });
+        std::future<response>      post(const url& u, const char* data, std::vector<header> headers = { });
+        std::future<response>       put(const url& u, std::string data, std::vector<header> headers = { });
+        std::future<response>       put(const url& u,        json data, std::vector<header> headers = { });
+        std::future<response>       put(const url& u, const char* data, std::vector<header> headers = { });
+        std::future<response>     patch(const url& u, std::string data, std::vector<header> headers = { });
+        std::future<response>     patch(const url& u,        json data, std::vector<header> headers = { });
+        std::future<response>     patch(const url& u, const char* data, std::vector<header> headers = { });
+        std::future<response> do_delete(const url& u,                   std::vector<header> headers = { });
+
+        // Sends the requests added since the last run and waits for all of them to finish.
+        void run();
+    };
+}
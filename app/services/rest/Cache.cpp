@@ -0,0 +1,444 @@
+#include "Cache.hpp"
+
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <unistd.h>
+
+namespace rest {
+    std::mutex                                            cache::mutex;
+    cache::lru                                            cache::entries;
+    std::unordered_map<std::string, cache::lru::iterator> cache::index;
+
+    size_t      cache::max_entries = 256;
+    size_t      cache::max_size    = 1 << 20;
+    std::string cache::directory;
+    long        cache::max_stale_s      = 86400;
+    long        cache::prune_interval_s = 3600;
+
+    static std::string lowercase(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+
+        return s;
+    }
+
+    static std::string trim(std::string_view s) {
+        size_t first = s.find_first_not_of(" \t");
+        size_t last  = s.find_last_not_of(" \t");
+
+        return first == s.npos ? "" : std::string(s.substr(first, last - first + 1));
+    }
+
+    // Splits a comma separated header value into trimmed lowercase items.
+    static std::vector<std::string> split(const std::string& value) {
+        std::vector<std::string> items;
+        std::stringstream        stream(value);
+        std::string              item;
+
+        while (std::getline(stream, item, ',')) {
+            if (!(item = lowercase(trim(item))).empty()) {
+                items.push_back(item);
+            }
+        }
+
+        return items;
+    }
+
+    // Parses a delta-seconds directive value, which may be quoted.
+    static std::optional<long> seconds(const std::string& value) {
+        try {
+            return std::stol(value.substr(value.starts_with('"')));
+        } catch (std::exception&) {
+            return std::nullopt;
+        }
+    }
+
+    static std::string find_header(const std::map<std::string, std::string>& headers, const std::string& name) {
+        auto it = headers.find(name);
+
+        return it == headers.end() ? "" : it->second;
+    }
+
+    static std::string find_header(const request& r, const std::string& name) {
+        for (auto& h : r.headers) {
+            size_t colon = h.find(':');
+
+            if (colon != h.npos && lowercase(h.substr(0, colon)) == name) {
+                return trim(std::string_view(h).substr(colon + 1));
+            }
+        }
+
+        return "";
+    }
+
+    // File name for a key. FNV-1a rather than std::hash, which may differ between builds sharing a directory.
+    static std::string file_of(const std::string& key) {
+        uint64_t hash = 14695981039346656037ull;
+
+        for (unsigned char c : key) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+
+        std::ostringstream name;
+
+        name << cache::directory << "/" << std::hex << hash;
+
+        return name.str();
+    }
+
+    // The names of the headers a response varies on, from its "name: value" lines.
+    static std::vector<std::string> names_of(const std::vector<header>& vary) {
+        std::vector<std::string> names;
+
+        for (auto& v : vary) {
+            names.push_back(v.substr(0, v.find(':')));
+        }
+
+        return names;
+    }
+
+    // Key of the variant of a URL for the given Vary lines. They are joined with CRs, which header values can't
+    // contain, and which keep the key on the first line of its file.
+    static std::string variant_key(const std::string& url, const std::vector<header>& vary) {
+        std::string key = url;
+
+        for (auto& v : vary) {
+            key += "\r" + v;
+        }
+
+        return key;
+    }
+
+    std::optional<cache::entry> cache::make_entry(const request& r, const response& res) {
+        if (res.status_code != 200 || res.data.size() > max_size) {
+            return std::nullopt;
+        }
+
+        std::optional<long> max_age, shared_max_age;
+        bool                no_cache = false, shared = false;
+
+        for (auto& directive : split(find_header(res.headers, "cache-control"))) {
+            if (directive == "no-store" || directive == "private") {
+                return std::nullopt;
+            } else if (directive == "no-cache") {
+                no_cache = true;
+            } else if (directive == "public") {
+                shared = true;
+            } else if (directive.starts_with("max-age=")) {
+                max_age = seconds(directive.substr(8));
+            } else if (directive.starts_with("s-maxage=")) {
+                shared_max_age = seconds(directive.substr(9));
+            }
+        }
+
+        // A response to a request carrying credentials is likely meant for that user only.
+        bool credentials = !find_header(r, "authorization").empty() || !find_header(r, "cookie").empty();
+
+        if (credentials && !shared && !shared_max_age) {
+            return std::nullopt;
+        }
+
+        max_age = shared_max_age ? shared_max_age : max_age;
+
+        entry e { .res = res, .etag = find_header(res.headers, "etag") };
+
+        if (!max_age && e.etag.empty()) {
+            return std::nullopt;
+        }
+
+        long age = 0;
+
+        try {
+            age = std::stol(find_header(res.headers, "age"));
+        } catch (std::exception&) { }
+
+        // Responses without max-age or marked no-cache are stored, but revalidated before every use.
+        e.expires = clock::now() + std::chrono::seconds(no_cache ? 0 : std::max(max_age.value_or(0) - age, 0L));
+
+        for (auto& name : split(find_header(res.headers, "vary"))) {
+            if (name == "*") {
+                return std::nullopt;
+            }
+
+            e.vary.push_back(name + ": " + find_header(r, name));
+        }
+
+        return e;
+    }
+
+    bool cache::matches(const entry& e, const request& r) {
+        auto names = names_of(e.vary);
+
+        for (size_t i = 0; i < names.size(); i++) {
+            if (e.vary[i] != names[i] + ": " + find_header(r, names[i])) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void cache::remember(const std::string& key, const entry& e) {
+        std::lock_guard lock(mutex);
+
+        auto it = index.find(key);
+
+        if (it != index.end()) {
+            entries.erase(it->second);
+        }
+
+        entries.emplace_front(key, e);
+        index[key] = entries.begin();
+
+        while (entries.size() > max_entries) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+    std::optional<cache::entry> cache::load(const std::string& key) {
+        std::optional<entry> found;
+
+        {
+            std::lock_guard lock(mutex);
+
+            auto it = index.find(key);
+
+            if (it != index.end()) {
+                entries.splice(entries.begin(), entries, it->second);
+
+                found = it->second->second;
+            }
+        }
+
+        // Another process may have stored a fresher response meanwhile.
+        if (!directory.empty() && (!found || clock::now() >= found->expires)) {
+            auto stored = read_file(key);
+
+            if (stored && (!found || stored->expires > found->expires)) {
+                remember(key, *stored);
+
+                found = stored;
+            }
+        }
+
+        return found;
+    }
+
+    void cache::store(const std::string& key, const entry& e) {
+        remember(key, e);
+
+        if (!directory.empty()) {
+            write_file(key, e);
+            prune();
+        }
+    }
+
+    void cache::prune() {
+        std::error_code ec;
+
+        // The modification time of this file tells every process when the directory was last searched.
+        auto marker = directory + "/pruned";
+        auto now    = std::filesystem::file_time_type::clock::now();
+        auto last   = std::filesystem::last_write_time(marker, ec);
+
+        if (!ec && now - last < std::chrono::seconds(prune_interval_s)) {
+            return;
+        }
+
+        std::ofstream(marker).put('\n');
+
+        for (auto& file : std::filesystem::directory_iterator(directory, ec)) {
+            auto name = file.path().filename().string();
+
+            if (name == "pruned") {
+                continue;
+            }
+
+            // Temporary files left behind by a process that died while writing.
+            if (name.find('.') != name.npos) {
+                auto written = std::filesystem::last_write_time(file.path(), ec);
+
+                if (!ec && now - written > std::chrono::seconds(prune_interval_s)) {
+                    std::filesystem::remove(file.path(), ec);
+                }
+
+                continue;
+            }
+
+            std::ifstream stream(file.path(), std::ios::binary);
+            std::string   key;
+            long long     expires;
+
+            if (std::getline(stream, key) && stream >> expires) {
+                auto stale = clock::now() - clock::time_point(std::chrono::milliseconds(expires));
+
+                if (stale > std::chrono::seconds(max_stale_s)) {
+                    std::filesystem::remove(file.path(), ec);
+                }
+            }
+        }
+    }
+
+    // The file format is a line each for the key, expiry, status code and ETag, the counted Vary and response
+    // header lines and finally the body, prefixed by its size.
+    std::optional<cache::entry> cache::read_file(const std::string& key) {
+        std::ifstream file(file_of(key), std::ios::binary);
+        std::string   line;
+        entry         e;
+        long long     expires;
+        size_t        count;
+
+        if (!std::getline(file, line) || line != key || !(file >> expires >> e.res.status_code >> std::ws) || !std::getline(file, e.etag)) {
+            return std::nullopt;
+        }
+
+        e.expires = clock::time_point(std::chrono::milliseconds(expires));
+
+        if (!(file >> count >> std::ws)) {
+            return std::nullopt;
+        }
+
+        for (size_t i = 0; i < count && std::getline(file, line); i++) {
+            e.vary.push_back(line);
+        }
+
+        if (!(file >> count >> std::ws)) {
+            return std::nullopt;
+        }
+
+        for (size_t i = 0; i < count && std::getline(file, line); i++) {
+            size_t colon = line.find(": ");
+
+            e.res.headers[line.substr(0, colon)] = colon == line.npos ? "" : line.substr(colon + 2);
+        }
+
+        if (!(file >> count) || file.get() != '\n') {
+            return std::nullopt;
+        }
+
+        e.res.data.resize(count);
+
+        if (!file.read(e.res.data.data(), count)) {
+            return std::nullopt;
+        }
+
+        return e;
+    }
+
+    void cache::write_file(const std::string& key, const entry& e) {
+        static std::atomic<size_t> counter = 0;
+
+        std::error_code ec;
+
+        std::filesystem::create_directories(directory, ec);
+
+        auto path = file_of(key);
+        auto temp = path + "." + std::to_string(getpid()) + "." + std::to_string(counter++);
+
+        {
+            std::ofstream file(temp, std::ios::binary);
+
+            file << key << "\n"
+                 << std::chrono::duration_cast<std::chrono::milliseconds>(e.expires.time_since_epoch()).count() << "\n"
+                 << e.res.status_code << "\n"
+                 << e.etag << "\n"
+                 << e.vary.size() << "\n";
+
+            for (auto& v : e.vary) {
+                file << v << "\n";
+            }
+
+            file << e.res.headers.size() << "\n";
+
+            for (auto& [name, value] : e.res.headers) {
+                file << name << ": " << value << "\n";
+            }
+
+            file << e.res.data.size() << "\n" << e.res.data;
+
+            if (!file.flush()) {
+                std::filesystem::remove(temp, ec);
+
+                return;
+            }
+        }
+
+        // Readers in other processes see either the old file or the complete new one.
+        std::filesystem::rename(temp, path, ec);
+    }
+
+    response cache::send(const request& r) {
+        if (r.method != "GET" || r.body || r.input || r.output) {
+            return rest::send(r);
+        }
+
+        auto url    = r.u.native();
+        auto key    = url;
+        auto cached = load(key);
+
+        // Responses with a Vary header are stored under a key of their own, the entry of the URL only names the
+        // headers they vary on.
+        if (cached && !cached->vary.empty()) {
+            std::vector<header> vary;
+
+            for (auto& name : names_of(cached->vary)) {
+                vary.push_back(name + ": " + find_header(r, name));
+            }
+
+            key    = variant_key(url, vary);
+            cached = load(key);
+        }
+
+        if (cached && !matches(*cached, r)) {
+            cached.reset();
+        }
+
+        if (cached && clock::now() < cached->expires) {
+            return cached->res;
+        }
+
+        request upstream = r;
+
+        if (cached && !cached->etag.empty()) {
+            upstream.headers.push_back("If-None-Match: " + cached->etag);
+        }
+
+        response res = rest::send(upstream);
+
+        if (cached && res.status_code == 304) {
+            // A 304 carries the headers that changed, such as a new max-age, but not the body or its length.
+            for (auto& [name, value] : res.headers) {
+                if (name != "content-length") {
+                    cached->res.headers[name] = value;
+                }
+            }
+
+            res = cached->res;
+        }
+
+        if (auto e = make_entry(r, res)) {
+            if (!e->vary.empty()) {
+                store(url, { .expires = e->expires, .vary = e->vary });
+            }
+
+            store(e->vary.empty() ? url : variant_key(url, e->vary), *e);
+        }
+
+        return res;
+    }
+
+    response cache::get(const url& u, std::vector<header> headers) {
+        return send({ .method = "GET", .u = u, .headers = std::move(headers) });
+    }
+
+    void cache::clear() {
+        std::lock_guard lock(mutex);
+
+        entries.clear();
+        index.clear();
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Rest.hpp"
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+
+namespace rest {
+    // Opt-in cache for GET requests to upstreams that send Cache-Control headers:
+    //
+    //     auto res = rest::cache::get("https://example.com/api/countries");
+    //
+    // Responses are served from the cache for as long as their max-age allows. Once stale, a response with an
+    // ETag is revalidated with If-None-Match, so an unchanged response costs a 304 instead of the whole body.
+    // Responses marked no-store, private or Vary: *, and responses other than 200, aren't cached. Neither are
+    // responses to requests sending Authorization or Cookie headers, unless marked public or s-maxage, since
+    // the cache is shared by every user. s-maxage takes precedence over max-age. Responses with a Vary header
+    // are stored per URL and values of the headers it names, so clients alternating e.g. Accept-Language each
+    // get their own variant.
+    //
+    // Every process keeps its most recently used responses in memory. Setting directory stores them on disk as
+    // well, where they are shared by every worker process and outlive a single request.
+    class cache {
+    public:
+        using clock = std::chrono::system_clock;
+
+        struct entry {
+            response            res;
+            std::string         etag;
+            clock::time_point   expires;
+
+            // The request headers the response varies on, as "name: value" with lowercase names.
+            std::vector<header> vary;
+        };
+
+        // The entry to store for a response to the request, if the response may be cached.
+        static std::optional<entry> make_entry(const request& r, const response& res);
+
+    private:
+        using lru = std::list<std::pair<std::string, entry>>;
+
+        static std::mutex                                     mutex;
+        static lru                                            entries;
+        static std::unordered_map<std::string, lru::iterator> index;
+
+        static std::optional<entry> load(const std::string& key);
+        static void                 store(const std::string& key, const entry& e);
+        static void              remember(const std::string& key, const entry& e);
+        static std::optional<entry> read_file(const std::string& key);
+        static void                 write_file(const std::string& key, const entry& e);
+
+        static bool                 matches(const entry& e, const request& r);
+        static void                 prune();
+
+    public:
+        // Responses kept in memory by each process.
+        static size_t      max_entries;
+
+        // Responses with larger bodies aren't cached.
+        static size_t      max_size;
+
+        // Directory to share cached responses between processes in, empty to cache in memory only. Files are
+        // replaced when their response is refreshed.
+        static std::string directory;
+
+        // Files of responses that have been stale for longer than this are removed from directory. Until then,
+        // a stale response with an ETag can still be revalidated instead of fetched again.
+        static long        max_stale_s;
+
+        // How often directory is searched for files to remove, by whichever process stores a response next.
+        static long        prune_interval_s;
+
+        // Sends a request, answering it from the cache when possible. Requests other than GET, and requests with
+        // a body or a sink, are sent as is.
+        static response send(const request& r);
+
+        static response get(const url& u, std::vector<header> headers = { });
+
+        // Forgets every response cached in memory. Files in directory are left alone.
+        static void clear();
+    };
+}
@@ -0,0 +1,108 @@
+#include "Handle.hpp"
+#include "Rest.hpp"
+
+#include <mutex>
+#include <algorithm>
+
+namespace rest {
+    thread_local handle::pool handle::instances;
+
+    size_t handle::max_origins = 8;
+
+    static std::mutex share_mutexes[CURL_LOCK_DATA_LAST];
+
+    static void lock_share(CURL* curl, curl_lock_data data, curl_lock_access access, void* userptr) {
+        share_mutexes[data].lock();
+    }
+
+    static void unlock_share(CURL* curl, curl_lock_data data, void* userptr) {
+        share_mutexes[data].unlock();
+    }
+
+    // DNS cache and TLS session IDs shared by every handle of the process.
+    static CURLSH* get_share() {
+        static struct share {
+            CURLSH* instance;
+
+             share() {
+                instance = curl_share_init();
+
+                curl_share_setopt(instance, CURLSHOPT_LOCKFUNC,   lock_share);
+                curl_share_setopt(instance, CURLSHOPT_UNLOCKFUNC, unlock_share);
+                curl_share_setopt(instance, CURLSHOPT_SHARE,      CURL_LOCK_DATA_DNS);
+                curl_share_setopt(instance, CURLSHOPT_SHARE,      CURL_LOCK_DATA_SSL_SESSION);
+            }
+
+            ~share() { curl_share_cleanup(instance); }
+        } s;
+
+        return s.instance;
+    }
+
+    handle::handle(std::string origin) : curl(curl_easy_init()), origin(origin) {
+        if (!curl) {
+            throw rest_error("Failed to initialize CURL connection.");
+        }
+    }
+
+    handle::~handle() {
+        curl_easy_cleanup(curl);
+    }
+
+    std::string handle::origin_of(const std::string& url) {
+        size_t scheme = url.find("://");
+        size_t start  = scheme == url.npos ? 0 : scheme + 3;
+        size_t end    = url.find_first_of("/?#", start);
+
+        return url.substr(0, end);
+    }
+
+    handle& handle::get(const std::string& url) {
+        auto& handles = instances.handles;
+        auto  key     = origin_of(url);
+
+        auto it = std::find_if(handles.begin(), handles.end(), [&](auto& h) { return h->origin == key; });
+
+        if (it == handles.end()) {
+            if (handles.size() >= max_origins && !handles.empty()) {
+                handles.pop_back();
+            }
+
+            handles.insert(handles.begin(), std::unique_ptr<handle>(new handle(key)));
+        } else if (it != handles.begin()) {
+            std::rotate(handles.begin(), it, it + 1);
+        }
+
+        // Resetting keeps the handle's open connections and caches.
+        curl_easy_reset(*handles.front());
+
+        configure(*handles.front());
+
+        return *handles.front();
+    }
+
+    void handle::configure(CURL* curl) {
+        curl_easy_setopt(curl, CURLOPT_SHARE,         get_share());
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION,  (long)CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL,      1L);
+    }
+
+    void handle::clear() {
+        instances.handles.clear();
+    }
+
+    header_list::header_list(const std::vector<header>& headers) {
+        for (auto& h : headers) {
+            append(h);
+        }
+    }
+
+    header_list::~header_list() {
+        curl_slist_free_all(list);
+    }
+
+    void header_list::append(const header& h) {
+        list = curl_slist_append(list, h.c_str());
+    }
+}
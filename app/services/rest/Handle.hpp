@@ -0,0 +1,73 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace rest {
+    using header = std::string;
+
+    // Reusable CURL easy handle. Every thread keeps one handle per origin, so consecutive requests to the same
+    // host reuse its open connection instead of resolving, connecting and negotiating TLS again. DNS results
+    // and TLS sessions are also shared between threads, which speeds up the first request of each thread.
+    class handle {
+    private:
+        CURL*       curl;
+        std::string origin;
+
+        struct pool {
+            // Most recently used first.
+            std::vector<std::unique_ptr<handle>> handles;
+        };
+
+        static thread_local pool instances;
+
+        handle(std::string origin);
+
+    public:
+        ~handle();
+
+        handle(const handle& ) = delete;
+        handle(      handle&&) = delete;
+
+        handle& operator=(const handle& ) = delete;
+        handle& operator=(      handle&&) = delete;
+
+        // Handles kept per thread, the least recently used one is closed when a new origin needs a handle.
+        static size_t max_origins;
+
+        // Returns this thread's handle for the origin (scheme, host and port) of the url, with its options
+        // reset to the defaults used by every request.
+        static handle& get(const std::string& url);
+
+        // Closes this thread's handles and their connections.
+        static void clear();
+
+        // Applies the options shared by every request: keep-alive, HTTP/2 and the process-wide DNS and TLS
+        // session cache.
+        static void configure(CURL* curl);
+
+        // The scheme, host and port of a url, e.g. "https://example.com:8443".
+        static std::string origin_of(const std::string& url);
+
+        operator CURL*() const { return curl; }
+    };
+
+    // Header list owned for the duration of a request.
+    class header_list {
+    private:
+        curl_slist* list = nullptr;
+
+    public:
+        header_list(const std::vector<header>& headers);
+        ~header_list();
+
+        header_list(const header_list& ) = delete;
+        header_list(      header_list&&) = delete;
+
+        void append(const header& h);
+
+        operator curl_slist*() const { return list; }
+    };
+}
@@ -0,0 +1,293 @@
+#include "Resilience.hpp"
+#include "Rest.hpp"
+
+#include <cerrno>
+#include <random>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+namespace rest {
+    retry_policy retry_policy::defaults { };
+
+    std::mutex                                      circuit_breaker::mutex;
+    std::map<std::string, circuit_breaker::circuit> circuit_breaker::circuits;
+
+    size_t      circuit_breaker::failure_threshold = 5;
+    long        circuit_breaker::open_ms           = 30000;
+    std::string circuit_breaker::directory;
+
+    bool is_idempotent(const std::string& method) {
+        return method == "GET" || method == "HEAD" || method == "PUT" || method == "DELETE" || method == "OPTIONS";
+    }
+
+    bool retry_policy::should_retry(const std::string& method, CURLcode ec, long status_code, size_t attempt) const {
+        if (attempt >= attempts || (!all_verbs && !is_idempotent(method))) {
+            return false;
+        }
+
+        switch (ec) {
+            case CURLE_OK:
+                return status_code == 429 || status_code == 502 || status_code == 503 || status_code == 504;
+
+            case CURLE_COULDNT_RESOLVE_HOST:
+            case CURLE_COULDNT_CONNECT:
+            case CURLE_OPERATION_TIMEDOUT:
+            case CURLE_SEND_ERROR:
+            case CURLE_RECV_ERROR:
+            case CURLE_GOT_NOTHING:
+            case CURLE_PARTIAL_FILE:
+            case CURLE_HTTP2:
+            case CURLE_HTTP2_STREAM:
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    std::chrono::milliseconds retry_policy::delay(size_t attempt) const {
+        thread_local std::mt19937 generator { std::random_device { }() };
+
+        long ceiling = base_delay_ms;
+
+        for (size_t i = 2; i < attempt && ceiling < max_delay_ms; i++) {
+            ceiling *= 2;
+        }
+
+        ceiling = std::min(ceiling, max_delay_ms);
+
+        return std::chrono::milliseconds(std::uniform_int_distribution<long>(0, std::max(ceiling, 0L))(generator));
+    }
+
+    circuit_breaker::permit::permit(permit&& other) : origin(std::move(other.origin)), trial(other.trial), pending(other.pending) {
+        other.pending = false;
+    }
+
+    circuit_breaker::permit& circuit_breaker::permit::operator=(permit&& other) {
+        if (this != &other) {
+            if (pending && trial) {
+                release(origin);
+            }
+
+            origin  = std::move(other.origin);
+            trial   = other.trial;
+            pending = other.pending;
+
+            other.pending = false;
+        }
+
+        return *this;
+    }
+
+    circuit_breaker::permit::~permit() {
+        if (pending && trial) {
+            release(origin);
+        }
+    }
+
+    void circuit_breaker::permit::record(bool success) {
+        if (!pending) {
+            return;
+        }
+
+        pending = false;
+
+        circuit_breaker::record(origin, success);
+    }
+
+    // File name for an origin. FNV-1a rather than std::hash, which may differ between builds sharing a directory.
+    static std::string file_of(const std::string& origin) {
+        uint64_t hash = 14695981039346656037ull;
+
+        for (unsigned char c : origin) {
+            hash = (hash ^ c) * 1099511628211ull;
+        }
+
+        std::ostringstream name;
+
+        name << circuit_breaker::directory << "/circuit-" << std::hex << hash;
+
+        return name.str();
+    }
+
+    static long long to_ms(std::chrono::system_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch()).count();
+    }
+
+    // The file format is a line each for the origin, state, failure count and the opened and trial times.
+    void circuit_breaker::update(const std::string& origin, const std::function<bool(circuit& c)>& change) {
+        std::lock_guard lock(mutex);
+
+        if (directory.empty()) {
+            auto it = circuits.find(origin);
+            auto c  = it == circuits.end() ? circuit { } : it->second;
+
+            if (change(c)) {
+                if (c.state == closed && c.failures == 0) {
+                    circuits.erase(origin);
+                } else {
+                    circuits[origin] = c;
+                }
+            }
+
+            return;
+        }
+
+        auto path = file_of(origin);
+        int  fd   = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+
+        if (fd < 0) {
+            // Healthy origins have no file, so only a change creates one.
+            circuit c;
+
+            if (!change(c)) {
+                return;
+            }
+
+            std::error_code ec;
+
+            std::filesystem::create_directories(directory, ec);
+
+            if ((fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)) < 0) {
+                return;
+            }
+        }
+
+        while (flock(fd, LOCK_EX) < 0 && errno == EINTR) { }
+
+        std::string data(512, '\0');
+        ssize_t     size = pread(fd, data.data(), data.size(), 0);
+
+        data.resize(std::max(size, (ssize_t)0));
+
+        std::istringstream stream(data);
+        std::string        stored;
+        circuit            c;
+        int                state;
+        long long          opened_at, trial_at;
+
+        if (std::getline(stream, stored) && stored == origin && stream >> state >> c.failures >> opened_at >> trial_at) {
+            c.state     = (state_t)state;
+            c.opened_at = clock::time_point(std::chrono::milliseconds(opened_at));
+            c.trial_at  = clock::time_point(std::chrono::milliseconds(trial_at));
+        } else {
+            c = { };
+        }
+
+        if (change(c)) {
+            std::ostringstream out;
+
+            out << origin << "\n" << (int)c.state << "\n" << c.failures << "\n" << to_ms(c.opened_at) << "\n" << to_ms(c.trial_at) << "\n";
+
+            data = out.str();
+
+            // Readers hold the lock as well, so they never see the file half written.
+            if (ftruncate(fd, 0) == 0) {
+                ssize_t written = pwrite(fd, data.data(), data.size(), 0);
+
+                (void)written;
+            }
+        }
+
+        close(fd);
+    }
+
+    circuit_breaker::permit circuit_breaker::allow(const std::string& origin) {
+        bool trial = false, blocked = false;
+
+        update(origin, [&](circuit& c) {
+            auto now  = clock::now();
+            auto wait = std::chrono::milliseconds(open_ms);
+
+            if (c.state == closed) {
+                return false;
+            }
+
+            if ((c.state == open && now - c.opened_at >= wait) || (c.state == half_open && now - c.trial_at >= wait)) {
+                // Let this request through as the trial, the others keep failing until it has finished.
+                c.state    = half_open;
+                c.trial_at = now;
+
+                return trial = true;
+            }
+
+            blocked = true;
+
+            return false;
+        });
+
+        if (blocked) {
+            throw rest_error("Failed to send request: the circuit for " + origin + " is open after repeated failures.", origin);
+        }
+
+        return { origin, trial };
+    }
+
+    void circuit_breaker::record(const std::string& origin, bool success) {
+        update(origin, [&](circuit& c) {
+            if (success) {
+                bool changed = c.state != closed || c.failures > 0;
+
+                c = { };
+
+                return changed;
+            }
+
+            c.failures++;
+
+            if (c.state == half_open || c.failures >= failure_threshold) {
+                c.state     = open;
+                c.opened_at = clock::now();
+            }
+
+            return true;
+        });
+    }
+
+    void circuit_breaker::release(const std::string& origin) {
+        update(origin, [](circuit& c) {
+            if (c.state != half_open) {
+                return false;
+            }
+
+            // Still open since opened_at, so the next request becomes the trial right away.
+            c.state = open;
+
+            return true;
+        });
+    }
+
+    circuit_breaker::state_t circuit_breaker::get_state(const std::string& origin) {
+        state_t state = closed;
+
+        update(origin, [&](circuit& c) {
+            state = c.state;
+
+            return false;
+        });
+
+        return state;
+    }
+
+    void circuit_breaker::reset() {
+        std::lock_guard lock(mutex);
+
+        circuits.clear();
+
+        if (directory.empty()) {
+            return;
+        }
+
+        std::error_code ec;
+
+        for (auto& file : std::filesystem::directory_iterator(directory, ec)) {
+            if (file.path().filename().string().starts_with("circuit-")) {
+                std::filesystem::remove(file.path(), ec);
+            }
+        }
+    }
+}
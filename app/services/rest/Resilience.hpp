@@ -0,0 +1,115 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <chrono>
+#include <functional>
+
+namespace rest {
+    // How often and how fast a failed request is retried. Only connection errors, timeouts and 429, 502, 503
+    // and 504 responses are retried, and only for idempotent verbs unless all_verbs is set.
+    struct retry_policy {
+        // Total number of attempts, 1 disables retrying.
+        size_t attempts      = 3;
+
+        // The delay before attempt n is picked at random between 0 and base_delay_ms * 2^(n - 2), capped at
+        // max_delay_ms. The randomness keeps clients from retrying against a recovering upstream in lockstep.
+        long   base_delay_ms = 100;
+        long   max_delay_ms  = 2000;
+
+        // Also retries POST and PATCH. Only safe when the upstream deduplicates these requests.
+        bool   all_verbs     = false;
+
+        // Used by requests that don't set their own policy.
+        static retry_policy defaults;
+
+        bool should_retry(const std::string& method, CURLcode ec, long status_code, size_t attempt) const;
+
+        // Delay before the given attempt, counted from 1.
+        std::chrono::milliseconds delay(size_t attempt) const;
+    };
+
+    // Fails requests to a host fast while it is unhealthy, instead of tying up workers waiting on timeouts.
+    // After failure_threshold consecutive failures (connection errors, timeouts or 5xx responses) the circuit
+    // opens and requests to the host throw right away. After open_ms a single trial request is let through,
+    // which closes the circuit again if it succeeds. The state is shared by every thread of the process, and by
+    // every process once directory is set.
+    class circuit_breaker {
+    public:
+        enum state_t {
+            closed,
+            open,
+            half_open
+        };
+
+    private:
+        // System time rather than steady time, since circuits stored in directory are shared between processes.
+        using clock = std::chrono::system_clock;
+
+        struct circuit {
+            state_t           state    = closed;
+            size_t            failures = 0;
+            clock::time_point opened_at;
+
+            // When the trial request of a half-open circuit was let through. A trial that hasn't reported back
+            // after open_ms, e.g. because its process died, is handed to the next request.
+            clock::time_point trial_at;
+        };
+
+        static std::mutex                      mutex;
+        static std::map<std::string, circuit>  circuits;
+
+        // Calls change with the circuit of the origin and stores the circuit if it returns true, holding a lock
+        // on the circuit meanwhile.
+        static void update(const std::string& origin, const std::function<bool(circuit& c)>& change);
+
+        static void record (const std::string& origin, bool success);
+        static void release(const std::string& origin);
+
+    public:
+        static size_t      failure_threshold;
+        static long        open_ms;
+
+        // Directory to share circuits between processes in, empty to keep them in memory. With one process per
+        // request, as under CGI, failures only add up when this is set. Every origin gets a file locked with
+        // flock while it is updated.
+        static std::string directory;
+
+        // A request let through by allow(), which reports its outcome through record(). When the trial request
+        // of a half-open circuit ends without one, e.g. because an exception was thrown, the trial is handed
+        // to the next request instead of blocking the circuit for good.
+        class permit {
+        private:
+            friend class circuit_breaker;
+
+            std::string origin;
+            bool        trial   = false;
+            bool        pending = true;
+
+            permit(std::string origin, bool trial) : origin(std::move(origin)), trial(trial) { }
+
+        public:
+            permit(const permit& ) = delete;
+            permit(      permit&& other);
+
+            permit& operator=(const permit& ) = delete;
+            permit& operator=(      permit&& other);
+
+            ~permit();
+
+            void record(bool success);
+        };
+
+        // Throws rest_error if requests to the origin should not be sent.
+        [[nodiscard]] static permit allow(const std::string& origin);
+
+        static state_t get_state(const std::string& origin);
+
+        // Closes every circuit, including those stored in directory.
+        static void reset();
+    };
+
+    bool is_idempotent(const std::string& method);
+}
@@ -6,8 +6,11 @@
 #include <map>
 #include <any>
 #include <functional>
+#include <ostream>
+#include <sstream>
 
 #include "Rest.hpp"
+#include "Sink.hpp"
 
 constexpr const char* get_response_message(unsigned int response_code) {
     switch(response_code) {
@@ -28,6 +31,9 @@ constexpr const char* get_response_message(unsigned int response_code) {
         case 405: return "Method Not Allowed";
         case 408: return "Request Timeout";
         case 500: return "Internal Server Error";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
     }
 
     return "Unknown";
@@ -50,10 +56,17 @@ struct response {
     }
 
     virtual std::string render() = 0;
+
+    // Writes the response to out. Responses producing their body incrementally override this to stream it.
+    virtual void render(std::ostream& out) {
+        out << render();
+    }
 };
 
 class html_response : public response {
 public:
+    using response::render;
+
     std::string html;
 
     std::string render() {
@@ -63,6 +76,8 @@ public:
 
 class data_response : public response {
 public:
+    using response::render;
+
     std::string data;
 
     std::string render() {
@@ -70,6 +85,36 @@ public:
     }
 };
 
+class stream_response : public response {
+public:
+    // Writes the body. It calls send_headers() before its first byte, once the status is known; whatever it
+    // throws before that can still be rendered as an error page.
+    std::function<void(std::ostream& out)> body;
+
+    bool headers_sent = false;
+
+    std::string render() {
+        std::ostringstream out;
+
+        render(out);
+
+        return out.str();
+    }
+
+    void render(std::ostream& out) {
+        body(out);
+        send_headers(out);
+    }
+
+    void send_headers(std::ostream& out) {
+        if (!headers_sent) {
+            headers_sent = true;
+
+            out << render_headers() << std::flush;
+        }
+    }
+};
+
 [[deprecated("Use view(rest::response) instead")]]
 inline std::unique_ptr<html_response> view(std::string html, unsigned int response_code = 200) {
     std::unique_ptr<html_response> res { new html_response };
@@ -122,3 +167,39 @@ inline std::unique_ptr<data_response> reply(rest::json json, int response_code =
         .data = json
     });
 }
+
+// Sends the upstream response body of a request to the client as it arrives, without holding it in memory.
+// The headers go out once the upstream status is known: upstream client errors are relayed as they are,
+// server errors become a 502, and anything else is sent as response_code. A request failing before that
+// throws as usual; one failing after it can only cut the body short.
+inline std::unique_ptr<stream_response> stream(std::string content_type, rest::request request, unsigned int response_code = 200) {
+    std::unique_ptr<stream_response> res { new stream_response };
+
+    res->response_code = response_code;
+    res->body          = [res = res.get(), request = std::move(request)](std::ostream& out) mutable {
+        request.output    = rest::to_stream(out);
+        request.on_status = [res, &out](int status_code) {
+            if (status_code >= 500) {
+                res->response_code = 502;
+            } else if (status_code >= 400) {
+                res->response_code = status_code;
+            }
+
+            res->send_headers(out);
+
+            return true;
+        };
+
+        try {
+            rest::send(request);
+        } catch (...) {
+            if (!res->headers_sent) {
+                throw;
+            }
+        }
+    };
+
+    res->headers.push_back("Content-Type: " + content_type);
+
+    return res;
+}
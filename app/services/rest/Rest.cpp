@@ -1,4 +1,11 @@
 #include "Rest.hpp"
+#include "Handle.hpp"
+#include "Source.hpp"
+
+#include <thread>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
 
 namespace rest {
     void swap      (url& lhs, url& rhs) noexcept { return lhs.swap(rhs); }
@@ -8,126 +15,256 @@ namespace rest {
 
     curl_initializer _initializer { };
 
-    int write_callback(char* data, size_t size, size_t nmemb,
-                       std::string* buffer) {
-        if (buffer == nullptr)
-            return 0;
+    long request::default_timeout_ms         = 30000;
+    long request::default_connect_timeout_ms = 10000;
 
-        buffer->append(data, size * nmemb);
+    static bool report_status(receiver& into) {
+        if (into.status_reported || !into.on_status) {
+            return true;
+        }
 
-        return size * nmemb;
+        into.status_reported = true;
+
+        return (*into.on_status)(into.res.status_code);
     }
 
-    response get(const url& u, std::vector<header> headers) {
-        CURL* curl = curl_easy_init();
+    size_t write_callback(char* data, size_t size, size_t nmemb, receiver* into) {
+        size_t bytes = size * nmemb;
 
-        if (!curl) {
-            throw rest_error("Failed to initialize CURL connection.");
+        into->received += bytes;
+
+        try {
+            if (!report_status(*into)) {
+                return 0;
+            }
+
+            if (into->output) {
+                // Empty chunks are reserved for marking the end of the body.
+                return bytes == 0 || (*into->output)(std::string_view(data, bytes)) ? bytes : 0;
+            }
+        } catch (...) {
+            into->error = std::current_exception();
+
+            return 0;
         }
 
-        response res;
+        into->res.data.append(data, bytes);
 
-        curl_easy_setopt(curl, CURLOPT_URL, u.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res.data);
+        return bytes;
+    }
 
-        curl_slist* headers_chunk = nullptr;
+    std::string failure(const request& r, CURLcode ec, const receiver& into) {
+        if (ec == CURLE_WRITE_ERROR && into.output) {
+            return "Failed to send " + r.method + " request: the response was aborted by its sink.";
+        }
 
-        for (header& h : headers)
-            headers_chunk = curl_slist_append(headers_chunk, h.c_str());
+        return "Failed to send " + r.method + " request: " + std::string(curl_easy_strerror(ec));
+    }
 
-        if (headers_chunk)
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_chunk);
+    size_t header_callback(char* data, size_t size, size_t nitems, receiver* into) {
+        std::string_view line(data, size * nitems);
 
-        CURLcode ec = curl_easy_perform(curl);
+        // Every status line starts a new set of headers, after a redirect or a 100 Continue.
+        if (line.starts_with("HTTP/")) {
+            size_t space = line.find(' ');
 
-        if (ec) {
-            curl_easy_cleanup(curl);
-            throw rest_error("Failed to send GET request: " + std::string(curl_easy_strerror(ec)), u);
+            into->res.headers.clear();
+            into->res.status_code = space == line.npos ? 0 : std::atoi(std::string(line.substr(space + 1, 3)).c_str());
+
+            return line.size();
         }
 
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &res.status_code);
-        curl_easy_cleanup(curl);
+        size_t colon = line.find(':');
+
+        if (colon != line.npos) {
+            std::string name(line.substr(0, colon));
+
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+
+            std::string_view value = line.substr(colon + 1);
+
+            value.remove_prefix(std::min(value.find_first_not_of(" \t"), value.size()));
+            value.remove_suffix(value.size() - std::min(value.find_last_not_of(" \t\r\n") + 1, value.size()));
 
-        return res;
+            auto& joined = into->res.headers[name];
+
+            joined += joined.empty() ? std::string(value) : ", " + std::string(value);
+        }
+
+        return line.size();
     }
 
-    response post(const url& u, std::string data, std::vector<header> headers) {
-        CURL* curl = curl_easy_init();
+    size_t read_callback(char* buffer, size_t size, size_t nitems, sender* from) {
+        try {
+            return from->input.read(buffer, size * nitems);
+        } catch (...) {
+            from->error = std::current_exception();
 
-        if (!curl) {
-            throw rest_error("Failed to initialize CURL connection.");
+            return CURL_READFUNC_ABORT;
         }
+    }
 
-        response res;
+    bool sender::rewind() {
+        return !input || (input.rewind && input.rewind());
+    }
+
+    void prepare(CURL* curl, const request& r, sender& from, receiver& into, header_list& headers) {
+        into.output    = r.output    ? &r.output    : nullptr;
+        into.on_status = r.on_status ? &r.on_status : nullptr;
+        from.input     = r.input;
 
-        curl_easy_setopt(curl, CURLOPT_URL, u.c_str());
+        curl_easy_setopt(curl, CURLOPT_URL, r.u.c_str());
         curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res.data);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &into);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &into);
+
+        if (r.compress && (r.input || r.body)) {
+            if (r.input) {
+                from.input = gzip(r.input);
+            } else {
+                from.compressed = gzip(*r.body);
+            }
+
+            headers.append("Content-Encoding: gzip");
+        }
+
+        if (from.input) {
+            // Don't wait for the upstream to confirm it accepts the body before sending it.
+            headers.append("Expect:");
 
-        curl_slist* headers_chunk = nullptr;
+            curl_easy_setopt(curl, CURLOPT_POST,                1L);
+            curl_easy_setopt(curl, CURLOPT_READFUNCTION,        read_callback);
+            curl_easy_setopt(curl, CURLOPT_READDATA,            &from);
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, from.input.size);
+        } else if (r.body) {
+            // Sent from the request without copying, and with an explicit size so binary bodies survive.
+            const std::string& body = r.compress ? from.compressed : *r.body;
 
-        for (header& h : headers)
-            headers_chunk = curl_slist_append(headers_chunk, h.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS,          body.data());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)body.size());
+        }
+
+        if (r.method == "HEAD") {
+            curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        } else if (r.method != "GET" && r.method != "POST") {
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, r.method.c_str());
+        }
+
+        if (headers) {
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, (curl_slist*)headers);
+        }
+
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS,        r.timeout_ms);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, r.connect_timeout_ms);
+    }
+
+    bool retryable(const request& r, CURLcode ec, long status_code, size_t attempt, sender& from, receiver& into) {
+        return !into.error && !from.error && !into.status_reported && (!into.output || into.received == 0) &&
+               from.rewind() && r.retry.should_retry(r.method, ec, status_code, attempt);
+    }
 
-        if (headers_chunk)
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_chunk);
+    response finish(const request& r, CURLcode ec, long status_code, sender& from, receiver& into) {
+        if (into.error) {
+            std::rethrow_exception(into.error);
+        }
 
-        CURLcode ec = curl_easy_perform(curl);
+        if (from.error) {
+            std::rethrow_exception(from.error);
+        }
 
         if (ec) {
-            curl_easy_cleanup(curl);
-            std::string str = std::string(curl_easy_strerror(ec));
-            throw rest_error("Failed to send POST request: " + str, u);
+            throw rest_error(failure(r, ec, into), r.u);
         }
 
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &res.status_code);
-        curl_easy_cleanup(curl);
+        into.res.status_code = (int)status_code;
 
-        return res;
+        if (!report_status(into) || (into.output && !(*into.output)({ }))) {
+            throw rest_error(failure(r, CURLE_WRITE_ERROR, into), r.u);
+        }
+
+        return std::move(into.res);
     }
 
-    response post(const url& u, json data, std::vector<header> headers) {
-        return post(u, (std::string)data, headers);
+    response send(const request& r) {
+        auto origin = handle::origin_of(r.u.native());
+
+        for (size_t attempt = 1;; attempt++) {
+            auto permit = circuit_breaker::allow(origin);
+
+            CURL* curl = handle::get(r.u.native());
+
+            sender      from;
+            receiver    into;
+            header_list headers(r.headers);
+
+            prepare(curl, r, from, into, headers);
+
+            CURLcode ec          = curl_easy_perform(curl);
+            long     status_code = 0;
+
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
+
+            // An exception from a callback is the caller's, not a failure of the upstream.
+            if (!into.error && !from.error) {
+                permit.record(ec == CURLE_OK && status_code < 500);
+            }
+
+            if (retryable(r, ec, status_code, attempt, from, into)) {
+                std::this_thread::sleep_for(r.retry.delay(attempt + 1));
+
+                continue;
+            }
+
+            return finish(r, ec, status_code, from, into);
+        }
     }
 
-    response post(const url& u, const char* data, std::vector<header> headers) {
-        return post(u, std::string(data), headers);
+    response get(const url& u, std::vector<header> headers) {
+        return send({ .method = "GET", .u = u, .headers = std::move(headers) });
     }
 
-    response do_delete(const url& u, std::vector<header> headers) {
-        CURL* curl = curl_easy_init();
+    response head(const url& u, std::vector<header> headers) {
+        return send({ .method = "HEAD", .u = u, .headers = std::move(headers) });
+    }
 
-        if (!curl) {
-            throw rest_error("Failed to initialize CURL connection.");
-        }
+    response post(const url& u, std::string data, std::vector<header> headers) {
+        return send({ .method = "POST", .u = u, .body = std::move(data), .headers = std::move(headers) });
+    }
 
-        response res;
+    response post(const url& u, json data, std::vector<header> headers) {
+        return post(u, (std::string)data, std::move(headers));
+    }
 
-        curl_easy_setopt(curl, CURLOPT_URL, u.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &res.data);
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+    response post(const url& u, const char* data, std::vector<header> headers) {
+        return post(u, std::string(data), std::move(headers));
+    }
 
-        curl_slist* headers_chunk = nullptr;
+    response put(const url& u, std::string data, std::vector<header> headers) {
+        return send({ .method = "PUT", .u = u, .body = std::move(data), .headers = std::move(headers) });
+    }
 
-        for (header& h : headers)
-            headers_chunk = curl_slist_append(headers_chunk, h.c_str());
+    response put(const url& u, json data, std::vector<header> headers) {
+        return put(u, (std::string)data, std::move(headers));
+    }
 
-        if (headers_chunk)
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_chunk);
+    response put(const url& u, const char* data, std::vector<header> headers) {
+        return put(u, std::string(data), std::move(headers));
+    }
 
-        CURLcode ec = curl_easy_perform(curl);
+    response patch(const url& u, std::string data, std::vector<header> headers) {
+        return send({ .method = "PATCH", .u = u, .body = std::move(data), .headers = std::move(headers) });
+    }
 
-        if (ec) {
-            curl_easy_cleanup(curl);
-            throw rest_error("Failed to send DELETE request: " + std::string(curl_easy_strerror(ec)), u);
-        }
+    response patch(const url& u, json data, std::vector<header> headers) {
+        return patch(u, (std::string)data, std::move(headers));
+    }
 
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &res.status_code);
-        curl_easy_cleanup(curl);
+    response patch(const url& u, const char* data, std::vector<header> headers) {
+        return patch(u, std::string(data), std::move(headers));
+    }
 
-        return res;
+    response do_delete(const url& u, std::vector<header> headers) {
+        return send({ .method = "DELETE", .u = u, .headers = std::move(headers) });
     }
 }
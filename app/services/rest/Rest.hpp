@@ -8,8 +8,14 @@
 #include <ostream>
 #include <concepts>
 #include <variant>
+#include <optional>
+#include <exception>
+#include <functional>
+#include <string_view>
 
 #include "../serialization/Json.hpp"
+#include "Handle.hpp"
+#include "Resilience.hpp"
 
 namespace rest {
     using json = ::json::json_value;
@@ -155,11 +161,12 @@ namespace rest {
     };
 
     struct response {
-        int  status_code;
+        int  status_code = 0;
         std::string data;
-    };
 
-    using header = std::string;
+        // Response headers by lowercase name, repeated headers joined with commas.
+        std::map<std::string, std::string> headers;
+    };
 
     class curl_initializer {
     public:
@@ -169,9 +176,115 @@ namespace rest {
     
     extern curl_initializer _initializer;
 
+    // Receives a response body chunk by chunk as it arrives. Returning false aborts the transfer.
+    using sink = std::function<bool(std::string_view chunk)>;
+
+    // Supplies a request body piece by piece, see Source.hpp.
+    struct source {
+        // Copies up to size bytes of the body into buffer and returns how many it copied, 0 once the whole body
+        // has been read or CURL_READFUNC_ABORT to abort the transfer.
+        std::function<size_t(char* buffer, size_t size)> read;
+
+        // Starts reading the body over again, returning false if that's impossible. Needed to retry a request.
+        std::function<bool()>                            rewind;
+
+        // Size of the body in bytes, -1 if it is unknown. Bodies of unknown size are sent chunked.
+        curl_off_t                                       size = -1;
+
+        explicit operator bool() const { return (bool)read; }
+    };
+
+    struct request {
+        std::string                method = "GET";
+        url                        u;
+        std::optional<std::string> body;
+        std::vector<header>        headers;
+
+        // Uploads the body from here instead of body, without copying it into memory first.
+        source                     input;
+
+        // Sends the body gzip compressed. Only worth it for large bodies, and only understood by upstreams
+        // accepting Content-Encoding: gzip.
+        bool                       compress           = false;
+
+        // Time allowed for the whole request and for connecting in milliseconds, 0 to wait indefinitely.
+        long                       timeout_ms         = default_timeout_ms;
+        long                       connect_timeout_ms = default_connect_timeout_ms;
+
+        retry_policy               retry              = retry_policy::defaults;
+
+        // Streams the response body here instead of collecting it in response::data, see Sink.hpp. Streamed
+        // requests are not retried once part of the body reached the sink.
+        sink                       output;
+
+        // Called with the status code once, right before the first chunk of the body is received or when the
+        // response turned out to have none. Returning false aborts the transfer.
+        std::function<bool(int status_code)> on_status;
+
+        // Used by requests that don't set their own timeouts, including the ones sent by get(), post() and
+        // do_delete().
+        static long default_timeout_ms;
+        static long default_connect_timeout_ms;
+    };
+
+    // Where a transfer writes its response, owned by the caller until the transfer is done.
+    struct receiver {
+        response    res;
+        const sink* output   = nullptr;
+
+        const std::function<bool(int)>* on_status       = nullptr;
+        bool                            status_reported = false;
+
+        // Body bytes received so far, whether collected or streamed.
+        size_t      received = 0;
+
+        // Thrown by output or on_status within a curl callback, which must not unwind through curl. Rethrown by
+        // finish() once the transfer returned.
+        std::exception_ptr error;
+    };
+
+    // Where a transfer reads its request body from, owned by the caller until the transfer is done.
+    struct sender {
+        source      input;
+        std::string compressed;
+
+        // Thrown by input within a curl callback, see receiver::error.
+        std::exception_ptr error;
+
+        // Prepares the body to be sent again, returns false if it can't be.
+        bool rewind();
+    };
+
+    // Sets the options of r on a CURL handle, reading the request body from from and writing the response into
+    // into. headers must be built from r.headers, prepare() adds the ones the body needs. All three must
+    // outlive the transfer.
+    void prepare(CURL* curl, const request& r, sender& from, receiver& into, header_list& headers);
+
+    // Error message for a transfer that failed with ec.
+    std::string failure(const request& r, CURLcode ec, const receiver& into);
+
+    // Whether a transfer that returned ec should be sent again, which is never the case once part of the response
+    // was handed to the caller.
+    bool retryable(const request& r, CURLcode ec, long status_code, size_t attempt, sender& from, receiver& into);
+
+    // Completes a transfer that returned ec and won't be retried: rethrows what its callbacks threw, reports
+    // the status and ends the streamed body. Throws rest_error if the transfer failed or its sink aborted it.
+    response finish(const request& r, CURLcode ec, long status_code, sender& from, receiver& into);
+
+    // Sends a request on this thread's pooled handle for its host, retrying it as its retry policy allows.
+    // Throws rest_error if it still fails, or right away if the host's circuit breaker is open.
+    response send(const request& r);
+
     response       get(const url& u,                   std::vector<header> headers = { });
+    response      head(const url& u,                   std::vector<header> headers = { });
     response      post(const url& u, std::string data, std::vector<header> headers = { });
     response      post(const url& u,        json data, std::vector<header> headers = { });
     response      post(const url& u, const char* data, std::vector<header> headers = { });
+    response       put(const url& u, std::string data, std::vector<header> headers = { });
+    response       put(const url& u,        json data, std::vector<header> headers = { });
+    response       put(const url& u, const char* data, std::vector<header> headers = { });
+    response     patch(const url& u, std::string data, std::vector<header> headers = { });
+    response     patch(const url& u,        json data, std::vector<header> headers = { });
+    response     patch(const url& u, const char* data, std::vector<header> headers = { });
     response do_delete(const url& u,                   std::vector<header> headers = { });
 }
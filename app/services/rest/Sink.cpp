@@ -0,0 +1,211 @@
+#include "Sink.hpp"
+
+#include <memory>
+#include <cctype>
+#include <cerrno>
+#include <unistd.h>
+
+namespace rest {
+    sink to_fd(int fd) {
+        return [fd](std::string_view chunk) {
+            while (!chunk.empty()) {
+                ssize_t written = write(fd, chunk.data(), chunk.size());
+
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    return false;
+                }
+
+                chunk.remove_prefix(written);
+            }
+
+            return true;
+        };
+    }
+
+    sink to_stream(std::ostream& out) {
+        return [&out](std::string_view chunk) {
+            out.write(chunk.data(), chunk.size());
+            out.flush();
+
+            return (bool)out;
+        };
+    }
+
+    sink lines(std::function<bool(std::string_view line)> on_line) {
+        auto pending = std::make_shared<std::string>();
+
+        return [on_line, pending](std::string_view chunk) {
+            if (chunk.empty()) {
+                return pending->empty() || on_line(*pending);
+            }
+
+            size_t end;
+
+            while ((end = chunk.find('\n')) != chunk.npos) {
+                std::string_view line = chunk.substr(0, end);
+
+                if (!pending->empty()) {
+                    pending->append(line);
+
+                    line = *pending;
+                }
+
+                if (line.ends_with('\r')) {
+                    line.remove_suffix(1);
+                }
+
+                if (!on_line(line)) {
+                    return false;
+                }
+
+                pending->clear();
+                chunk.remove_prefix(end + 1);
+            }
+
+            pending->append(chunk);
+
+            return true;
+        };
+    }
+
+    // Splits a streamed JSON document into the elements of its top-level array.
+    struct json_splitter {
+        enum mode_t {
+            start,
+            array,
+            document,
+            done
+        };
+
+        std::function<bool(json element)> on_element;
+
+        std::string buffer;
+        mode_t      mode      = start;
+        size_t      depth     = 0;
+        bool        in_string = false;
+        bool        escaped   = false;
+
+        bool emit() {
+            if (buffer.find_first_not_of(" \t\r\n") == buffer.npos) {
+                buffer.clear();
+
+                return true;
+            }
+
+            // The parser only accepts objects and arrays as documents, so array elements are parsed wrapped in one.
+            json element = mode == document ? ::json::parser().parse(buffer) : ::json::parser().parse("[" + buffer + "]")[0];
+
+            buffer.clear();
+
+            return on_element(element);
+        }
+
+        bool feed(std::string_view chunk) {
+            if (chunk.empty()) {
+                if (mode == document) {
+                    return emit();
+                }
+
+                // A body cut off inside the array would otherwise drop its last element without an error.
+                return mode != array && buffer.empty();
+            }
+
+            for (size_t i = 0; i < chunk.size(); i++) {
+                char c = chunk[i];
+
+                if (mode == start) {
+                    if (std::isspace((unsigned char)c)) {
+                        continue;
+                    }
+
+                    if (c == '[') {
+                        mode = array;
+
+                        continue;
+                    }
+
+                    mode = document;
+                }
+
+                if (mode == document) {
+                    buffer.append(chunk.substr(i));
+
+                    return true;
+                }
+
+                if (mode == done) {
+                    return true;
+                }
+
+                if (in_string) {
+                    if (escaped) {
+                        escaped = false;
+                    } else if (c == '\\') {
+                        escaped = true;
+                    } else if (c == '"') {
+                        in_string = false;
+                    }
+
+                    buffer += c;
+
+                    continue;
+                }
+
+                switch (c) {
+                    case '"':
+                        in_string = true;
+                        break;
+
+                    case '[':
+                    case '{':
+                        depth++;
+                        break;
+
+                    case ']':
+                    case '}':
+                        if (depth == 0) {
+                            mode = done;
+
+                            if (!emit()) {
+                                return false;
+                            }
+
+                            continue;
+                        }
+
+                        depth--;
+                        break;
+
+                    case ',':
+                        if (depth == 0) {
+                            if (!emit()) {
+                                return false;
+                            }
+
+                            continue;
+                        }
+
+                        break;
+                }
+
+                buffer += c;
+            }
+
+            return true;
+        }
+    };
+
+    sink json_elements(std::function<bool(json element)> on_element) {
+        auto splitter = std::make_shared<json_splitter>();
+
+        splitter->on_element = on_element;
+
+        return [splitter](std::string_view chunk) {
+            return splitter->feed(chunk);
+        };
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Rest.hpp"
+
+#include <ostream>
+#include <functional>
+#include <string_view>
+
+namespace rest {
+    // Ready-made sinks for request::output:
+    //
+    //     rest::send({ .u = "https://example.com/export.json", .output = rest::json_elements([](rest::json row) {
+    //         import(row);
+    //
+    //         return true;
+    //     }) });
+    //
+    // A sink is called with an empty chunk once the whole body has been received.
+
+    // Writes the body to a file descriptor, such as an open file or STDOUT_FILENO.
+    sink to_fd(int fd);
+
+    // Writes the body to a stream, flushing it after every chunk so a client reading it sees the data right away.
+    sink to_stream(std::ostream& out);
+
+    // Calls on_line with every line of the body without its line break, for NDJSON and other line based
+    // formats. Only the line being received is buffered.
+    sink lines(std::function<bool(std::string_view line)> on_line);
+
+    // Calls on_element with every element of a JSON array as soon as it has been received, so only the element
+    // being received is buffered. Any other JSON document is passed to on_element whole once it is complete. A body
+    // that ends before the array is closed fails the request.
+    sink json_elements(std::function<bool(json element)> on_element);
+}
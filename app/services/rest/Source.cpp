@@ -0,0 +1,185 @@
+#include "Source.hpp"
+
+#include <memory>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+namespace rest {
+    source from_buffer(std::string_view data) {
+        auto offset = std::make_shared<size_t>(0);
+
+        return {
+            .read = [data, offset](char* buffer, size_t size) {
+                size_t n = data.copy(buffer, size, *offset);
+
+                *offset += n;
+
+                return n;
+            },
+            .rewind = [offset]() {
+                *offset = 0;
+
+                return true;
+            },
+            .size = (curl_off_t)data.size()
+        };
+    }
+
+    source from_fd(int fd, curl_off_t size) {
+        off_t start = lseek(fd, 0, SEEK_CUR);
+
+        return {
+            .read = [fd](char* buffer, size_t size) -> size_t {
+                ssize_t n;
+
+                while ((n = read(fd, buffer, size)) < 0 && errno == EINTR);
+
+                return n < 0 ? CURL_READFUNC_ABORT : n;
+            },
+            .rewind = [fd, start]() {
+                return start >= 0 && lseek(fd, start, SEEK_SET) == start;
+            },
+            .size = size
+        };
+    }
+
+    source from_file(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        struct stat info;
+
+        if (fd < 0 || fstat(fd, &info) < 0) {
+            if (fd >= 0) {
+                close(fd);
+            }
+
+            throw rest_error("Cannot upload " + path + ": the file could not be opened.");
+        }
+
+        // Closes the file once the last copy of the source is gone.
+        auto file = std::shared_ptr<void>(nullptr, [fd](void*) { close(fd); });
+        auto s    = from_fd(fd, info.st_size);
+
+        return {
+            .read   = [file, read = s.read](char* buffer, size_t size) { return read(buffer, size); },
+            .rewind = s.rewind,
+            .size   = s.size
+        };
+    }
+
+    source from_stream(std::istream& in, curl_off_t size) {
+        auto start = in.tellg();
+
+        return {
+            .read = [&in](char* buffer, size_t size) -> size_t {
+                in.read(buffer, size);
+
+                return in.bad() ? CURL_READFUNC_ABORT : in.gcount();
+            },
+            .rewind = [&in, start]() {
+                in.clear();
+                in.seekg(start);
+
+                return start != std::streampos(-1) && !in.fail();
+            },
+            .size = size
+        };
+    }
+
+    // Deflates a source into the gzip format as it is read.
+    struct deflater {
+        source   input;
+        z_stream stream { };
+        char     buffer[16384];
+        bool     ended    = false;
+        bool     finished = false;
+
+        deflater(source input) : input(std::move(input)) {
+            // 15 window bits plus 16 selects the gzip header instead of the zlib one.
+            if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                throw rest_error("Failed to initialize gzip compression.");
+            }
+        }
+
+        ~deflater() { deflateEnd(&stream); }
+
+        size_t read(char* output, size_t size) {
+            stream.next_out  = (Bytef*)output;
+            stream.avail_out = size;
+
+            while (stream.avail_out > 0 && !finished) {
+                if (stream.avail_in == 0 && !ended) {
+                    size_t n = input.read(buffer, sizeof(buffer));
+
+                    if (n == CURL_READFUNC_ABORT) {
+                        return CURL_READFUNC_ABORT;
+                    }
+
+                    ended            = n == 0;
+                    stream.next_in   = (Bytef*)buffer;
+                    stream.avail_in  = n;
+                }
+
+                int status = deflate(&stream, ended ? Z_FINISH : Z_NO_FLUSH);
+
+                if (status == Z_STREAM_END) {
+                    finished = true;
+                } else if (status != Z_OK && status != Z_BUF_ERROR) {
+                    return CURL_READFUNC_ABORT;
+                }
+            }
+
+            return size - stream.avail_out;
+        }
+
+        bool rewind() {
+            if (!input.rewind || !input.rewind()) {
+                return false;
+            }
+
+            ended           = false;
+            finished        = false;
+            stream.avail_in = 0;
+
+            return deflateReset(&stream) == Z_OK;
+        }
+    };
+
+    source gzip(source input) {
+        auto d = std::make_shared<deflater>(std::move(input));
+
+        return {
+            .read   = [d](char* buffer, size_t size) { return d->read(buffer, size); },
+            .rewind = [d]() { return d->rewind(); }
+        };
+    }
+
+    std::string gzip(std::string_view data) {
+        z_stream stream { };
+
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw rest_error("Failed to initialize gzip compression.");
+        }
+
+        std::string output(deflateBound(&stream, data.size()), '\0');
+
+        stream.next_in   = (Bytef*)data.data();
+        stream.avail_in  = data.size();
+        stream.next_out  = (Bytef*)output.data();
+        stream.avail_out = output.size();
+
+        int status = deflate(&stream, Z_FINISH);
+
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        if (status != Z_STREAM_END) {
+            throw rest_error("Failed to compress request body.");
+        }
+
+        return output;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Rest.hpp"
+
+#include <istream>
+#include <string>
+#include <string_view>
+
+namespace rest {
+    // Ready-made sources for request::input:
+    //
+    //     rest::send({ .method = "PUT", .u = "https://example.com/backup.tar", .input = rest::from_file("backup.tar") });
+    //
+    // Sources that can be rewound let the request be retried.
+
+    // Uploads data without copying it. data must outlive the request.
+    source from_buffer(std::string_view data);
+
+    // Uploads from a file descriptor, starting at its current position. Pass size if it is known, otherwise the
+    // body is sent chunked. Only seekable descriptors can be rewound.
+    source from_fd(int fd, curl_off_t size = -1);
+
+    // Uploads a file, which is kept open until the request is done. Throws rest_error if it can't be opened.
+    source from_file(const std::string& path);
+
+    // Uploads from a stream, starting at its current position. in must outlive the request.
+    source from_stream(std::istream& in, curl_off_t size = -1);
+
+    // Compresses a body with gzip while it is uploaded. Its compressed size is unknown, so it is sent chunked.
+    source      gzip(source input);
+    std::string gzip(std::string_view data);
+}
@@ -148,18 +148,24 @@ void router() {
             std::string route_url = clean_url(route.uri);
 
             if(contains(route.verb, verb) && (route_url == url || complete_route(route_url, url, params))) {
-                std::cout << route.callback(params)->render() << std::flush;
+                route.callback(params)->render(std::cout);
+
+                std::cout << std::flush;
 
                 return;
             }
         }
 
-        std::cout << error_routes[404]({})->render() << std::flush;
+        error_routes[404]({})->render(std::cout);
+
+        std::cout << std::flush;
     } catch(std::exception& e) {
         std::map<std::string, std::any> params;
         params.insert({ "e", &e });
 
-        std::cout << error_routes[500](params)->render() << std::flush;
+        error_routes[500](params)->render(std::cout);
+
+        std::cout << std::flush;
     }
 }
 
@@ -170,7 +176,9 @@ void segfault_sigaction(int signal, siginfo_t *si, void *arg) {
 
     params.insert({ "e", static_cast<std::exception*>(&e) });
 
-    std::cout << error_routes[500](params)->render() << std::flush;
+    error_routes[500](params)->render(std::cout);
+
+    std::cout << std::flush;
 
     exit(0);
 }
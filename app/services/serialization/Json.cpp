@@ -77,30 +77,30 @@ namespace json {
     json& json::operator=(      json_value&& value) { return *this = value.operator json(); }
 
     json serializer::serialize(base_model& model) const {
-        auto& properties = get_properties(model);
+        auto properties = get_properties(model);
 
         json object;
 
         for(auto& key_value_pair : properties) {
-            auto value = key_value_pair.second->serialize_value();
-
-            switch(value.type) {
-                case serialized::integer:        object[key_value_pair.first] = std::get<long long     >(value.value); break;
-                case serialized::floating_point: object[key_value_pair.first] = std::get<long double   >(value.value); break;
-                case serialized::boolean:        object[key_value_pair.first] = std::get<bool          >(value.value); break;
-                case serialized::null:           object[key_value_pair.first] = std::get<std::nullptr_t>(value.value); break;
-                case serialized::string:         object[key_value_pair.first] = std::get<std::string   >(value.value); break;
-            }
+            key_value_pair.second->visit([&](auto&& value) {
+                using T = std::decay_t<decltype(value)>;
+
+                if constexpr (std::same_as<T, std::string_view>) {
+                    object[key_value_pair.first] = std::string(value);
+                } else if constexpr (natively_serializable<T>) {
+                    object[key_value_pair.first] = value;
+                }
+            });
         }
 
         return object;
     }
 
     void serializer::deserialize(base_model& model, json object) const {
-        auto& properties = get_properties(model);
+        auto properties = get_properties(model);
 
         for(auto& key_value_pair : properties) {
-            auto value = key_value_pair.second->serialize_value();
+            serialized value { .type = key_value_pair.second->serialized_type() };
 
             auto& json_val = object[key_value_pair.first];
 
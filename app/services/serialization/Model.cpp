@@ -1,14 +1,94 @@
 #include "Model.hpp"
 
-std::map<std::string, base_property*>& base_serializer::get_properties(base_model& model) const {
-    return model.properties;
+#include <mutex>
+#include <memory>
+#include <typeindex>
+#include <shared_mutex>
+#include <unordered_map>
+
+property_map base_serializer::get_properties(base_model& model) const {
+    return model.properties();
+}
+
+property_list base_serializer::get_sorted_properties(base_model& model) const {
+    return model.sorted_properties();
+}
+
+const property_layout& property_layout::of(const base_model& model) {
+    if (auto cached = model.layout.load(std::memory_order_acquire)) {
+        return *cached;
+    }
+
+    static std::shared_mutex                                                      mutex;
+    static std::unordered_map<std::type_index, std::unique_ptr<property_layout>> layouts;
+
+    std::type_index type = typeid(model);
+
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+
+        auto it = layouts.find(type);
+
+        if (it != layouts.end()) {
+            model.layout.store(it->second.get(), std::memory_order_release);
+
+            return *it->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+
+    auto& layout = layouts[type];
+
+    if (!layout) {
+        layout.reset(new property_layout());
+
+        for (auto property = model.last_property; property; property = property->next) {
+            layout->sorted.emplace_back(std::string(property->key), (const char*)property - (const char*)&model);
+        }
+
+        std::reverse(layout->sorted.begin(), layout->sorted.end());
+
+        for (auto& [key, offset] : layout->sorted) {
+            layout->keys.emplace(key, offset);
+        }
+
+        for (auto member = model.last_member; member; member = member->next_member) {
+            layout->members.emplace(member->member_name(), (const char*)member - (const char*)&model);
+        }
+    }
+
+    model.layout.store(layout.get(), std::memory_order_release);
+
+    return *layout;
+}
+
+layout_member* property_layout::find_member(base_model& model, std::string_view name) {
+    auto& members = of(model).members;
+    auto  it      = members.find(name);
+
+    return it == members.end() ? nullptr : (layout_member*)((char*)&model + it->second);
+}
+
+void layout_member::register_member(base_model* model) {
+    next_member        = model->last_member;
+    model->last_member = this;
 }
 
-std::vector<std::pair<std::string, base_property*>>& base_serializer::get_sorted_properties(base_model& model) const {
-    return model.sorted_properties;
+void base_property::register_property(base_model* model) {
+    next                 = model->last_property;
+    model->last_property = this;
+}
+
+bool base_model::is_dirty() const {
+    for (auto& [key, offset] : property_layout::of(*this).sorted)
+        if (((const base_property*)((const char*)this + offset))->is_dirty())
+            return true;
+
+    return false;
 }
 
-void base_property::register_property() {
-    model->properties.insert(std::make_pair(key, this));
-    model->sorted_properties.push_back(std::make_pair(key, this));
+void base_model::mark_clean() {
+    for (auto& property : sorted_properties())
+        property.second->mark_clean();
 }
@@ -1,23 +1,152 @@
 #pragma once
 
-#include <vector>
 #include <map>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <optional>
+#include <algorithm>
+#include <functional>
 
 #include "Property.hpp"
 
 class base_model;
 
+// Named member of a model that isn't a property but is still looked up by name, such as db::base_relation.
+// Linked into the model by its constructor like properties are, so its offset ends up in the layout.
+class layout_member {
+protected:
+    friend class property_layout;
+
+    layout_member* next_member = nullptr;
+
+    void register_member(base_model* model);
+
+    virtual const std::string& member_name() const = 0;
+
+    layout_member() = default;
+
+    // Copies are not linked, the layout was built from the first instance of the type.
+    layout_member(const layout_member& ) { }
+    layout_member(      layout_member&&) { }
+
+    layout_member& operator=(const layout_member& ) { return *this; }
+    layout_member& operator=(      layout_member&&) { return *this; }
+
+public:
+    virtual ~layout_member() = default;
+};
+
+// Properties of a model type as offsets from the model, in declaration order and by key. Built the first
+// time the type is used and shared by all of its instances, so models don't carry their own tables.
+class property_layout {
+public:
+    std::vector<std::pair<std::string, ptrdiff_t>>  sorted;
+    std::map<std::string, ptrdiff_t, std::less<>>   keys;
+
+    // Offsets of the layout_member subobjects by name.
+    std::map<std::string, ptrdiff_t, std::less<>>   members;
+
+    static const property_layout& of(const base_model& model);
+
+    // nullptr if the model has no member of that name.
+    static layout_member* find_member(base_model& model, std::string_view name);
+};
+
+template<class Iterator>
+class property_iterator {
+private:
+    Iterator    it;
+    base_model* model;
+
+    mutable std::optional<std::pair<const std::string&, base_property*>> current;
+
+public:
+    property_iterator(Iterator it, base_model* model) : it(it), model(model) { }
+
+    std::pair<const std::string&, base_property*>& operator*() const {
+        current.emplace(it->first, (base_property*)((char*)model + it->second));
+
+        return *current;
+    }
+
+    std::pair<const std::string&, base_property*>* operator->() const { return &**this; }
+
+    property_iterator& operator++() { ++it; return *this; }
+
+    bool operator==(const property_iterator& other) const { return it == other.it; }
+};
+
+// The properties of one model, resolved from the layout of its type.
+template<class Container>
+class property_view {
+private:
+    const Container* container;
+    base_model*      model;
+
+public:
+    using iterator = property_iterator<typename Container::const_iterator>;
+
+    property_view(const Container& container, base_model* model) : container(&container), model(model) { }
+
+    iterator begin() const { return { container->begin(), model }; }
+    iterator end()   const { return { container->end(),   model }; }
+
+    size_t size() const { return container->size(); }
+
+    iterator find(std::string_view key) const requires requires(const Container& c) { c.find(key); } {
+        return { container->find(key), model };
+    }
+
+    // nullptr if the model has no such property.
+    base_property* operator[](std::string_view key) const requires requires(const Container& c) { c.find(key); } {
+        auto it = find(key);
+
+        return it == end() ? nullptr : it->second;
+    }
+};
+
+using property_map  = property_view<std::map<std::string, ptrdiff_t, std::less<>>>;
+using property_list = property_view<std::vector<std::pair<std::string, ptrdiff_t>>>;
+
 class base_serializer {
 protected:
-    std::map<std::string, base_property*>& get_properties(base_model& model) const;
-    std::vector<std::pair<std::string, base_property*>>& get_sorted_properties(base_model& model) const;
+    property_map  get_properties       (base_model& model) const;
+    property_list get_sorted_properties(base_model& model) const;
 };
 
 class base_model {
 protected:
     friend class base_property;
     friend class base_serializer;
+    friend class property_layout;
+    friend class layout_member;
+
+    // Properties and members linked by their constructors, last one first. Only read to build the layout
+    // of the type.
+    base_property* last_property = nullptr;
+    layout_member* last_member   = nullptr;
+
+    // Cache of property_layout::of(), filled on first use from whichever thread gets there first.
+    mutable std::atomic<const property_layout*> layout = nullptr;
+
+    property_map  properties()        { return { property_layout::of(*this).keys,   this }; }
+    property_list sorted_properties() { return { property_layout::of(*this).sorted, this }; }
+
+public:
+    base_model() = default;
+
+    // Copies share the layout of their source, the properties they copied still link into the source.
+    base_model(const base_model& other) : layout(&property_layout::of(other)) { }
+    base_model(      base_model&& other) : layout(&property_layout::of(other)) { }
+
+    base_model& operator=(const base_model& ) { return *this; }
+    base_model& operator=(      base_model&&) { return *this; }
+
+    virtual ~base_model() = default;
 
-    std::map<std::string, base_property*> properties;
-    std::vector<std::pair<std::string, base_property*>> sorted_properties;
+    // True if any property changed since the model was loaded or last saved.
+    bool is_dirty() const;
+    void mark_clean();
 };
@@ -3,6 +3,7 @@
 #include "Serializable.hpp"
 
 #include <stdexcept>
+#include <string_view>
 
 class base_serializer;
 class base_model;
@@ -10,13 +11,22 @@ class base_model;
 class base_property {
 protected:
     friend class base_serializer;
+    friend class property_layout;
 
-    std::string key;
-    base_model* model;
+    // Only read when the layout of the model type is built, which may happen long after the constructor
+    // returned. Referenced rather than copied, so the constructors only take character arrays such as
+    // string literals and a temporary std::string can't be passed by mistake.
+    std::string_view key;
 
-    void register_property();
+    // Next property of the model being constructed, see base_model::last_property.
+    base_property* next = nullptr;
 
-    base_property(std::string key, base_model* model) : key(key), model(model) { }
+    // Set when the value changes after the model was loaded or saved.
+    bool dirty = false;
+
+    void register_property(base_model* model);
+
+    base_property(std::string_view key) : key(key) { }
 
     base_property(const base_property & ) = default;
     base_property(      base_property &&) = default;
@@ -27,6 +37,24 @@ protected:
 public:
     virtual serialized serialize_value() = 0;
     virtual void deserialize_value(serialized val) = 0;
+
+    // Passes the value to the matching overload of visitor by reference, where serialize_value() copies it.
+    // Prefer this for values that are only read, such as when binding or writing them.
+    virtual void visit(serialized_visitor& visitor) = 0;
+
+    // Same as above for any callable taking each of the visited types, e.g. a generic lambda.
+    template<class F> requires (!std::derived_from<std::remove_cvref_t<F>, serialized_visitor>)
+    void visit(F&& callback) {
+        serialized_visitor_for<std::remove_reference_t<F>> visitor(callback);
+
+        visit((serialized_visitor&)visitor);
+    }
+
+    // Type of the value serialize_value() returns, without serializing it.
+    virtual serialized::type_t serialized_type() const = 0;
+
+    bool is_dirty() const { return dirty; }
+    void mark_clean()     { dirty = false; }
 };
 
 template<serializable T>
@@ -55,6 +83,32 @@ public:
         return { };
     }
 
+    using base_property::visit;
+
+    void visit(serialized_visitor& visitor) {
+        if constexpr(std::same_as<bool,           T>)                 { visitor(                                          value ); return; }
+        if constexpr(std::floating_point         <T>)                 { visitor((long double)                             value ); return; }
+        if constexpr(std::integral               <T>)                 { visitor((long   long)                             value ); return; }
+        if constexpr(std::same_as<std::nullptr_t, T>)                 { visitor(nullptr                                         ); return; }
+        if constexpr(std::convertible_to<const T&, std::string_view>) { visitor(std::string_view(                         value)); return; }
+        if constexpr(to_string_serializable      <T>)                 { visitor(std::string_view(std::string(             value))); return; }
+        if constexpr(std::same_as<std::shared_ptr<base_model>, T>)    { visitor(                                          value ); return; }
+        if constexpr(model_serializable          <T>)                 { visitor(std::shared_ptr<base_model>(              value)); return; }
+        if constexpr(model_container_serializable<T>)                 { visitor(std::vector<std::shared_ptr<base_model>>(value.begin(), value.end())); return; }
+    }
+
+    serialized::type_t serialized_type() const {
+        if constexpr(std::same_as<bool,           T>) return serialized::boolean;
+        if constexpr(std::floating_point         <T>) return serialized::floating_point;
+        if constexpr(std::integral               <T>) return serialized::integer;
+        if constexpr(std::same_as<std::nullptr_t, T>) return serialized::null;
+        if constexpr(to_string_serializable      <T>) return serialized::string;
+        if constexpr(model_serializable          <T>) return serialized::model;
+        if constexpr(model_container_serializable<T>) return serialized::models;
+
+        return serialized::null;
+    }
+
     void deserialize_value_b(serialized val) requires(std::same_as<bool,           T>) { if (val.type != serialized::boolean       ) throw std::bad_cast(); value = std::get<bool                                    >(val.value); }
     void deserialize_value_f(serialized val) requires(std::floating_point         <T>) { if (val.type != serialized::floating_point) throw std::bad_cast(); value = std::get<long double                             >(val.value); }
     void deserialize_value_i(serialized val) requires(std::integral               <T>) { if (val.type != serialized::integer       ) throw std::bad_cast(); value = std::get<long long                               >(val.value); }
@@ -64,6 +118,8 @@ public:
     void deserialize_value_M(serialized val) requires(model_container_serializable<T>) { if (val.type != serialized::models        ) throw std::bad_cast(); value = std::get<std::vector<std::shared_ptr<base_model>>>(val.value); }
 
     void deserialize_value(serialized val) {
+        dirty = true;
+
         // bool might show up as 0 / 1 in some cases instead of false / true, such as in SQL.
         if constexpr(std::same_as<bool,           T>) { try { deserialize_value_b(val); } catch (std::bad_cast& e) { deserialize_value_i(val); } return; }
         if constexpr(std::floating_point         <T>) { deserialize_value_f(val); return; }
@@ -77,16 +133,28 @@ public:
     property(const property<T>&  value) requires (std::copy_constructible<T>) = default;
     property(      property<T>&& value) requires (std::move_constructible<T>) = default;
 
-    property(base_model* model, std::string key)                  requires (std::default_initializable<T>) : base_property(key, model)               { register_property(); }
-    property(base_model* model, std::string key, const T&  value) requires (std::copy_constructible   <T>) : base_property(key, model), value(value) { register_property(); }
-    property(base_model* model, std::string key,       T&& value) requires (std::move_constructible   <T>) : base_property(key, model), value(value) { register_property(); }
+    template<size_t N> property(base_model* model, const char (&key)[N])                  requires (std::default_initializable<T>) : base_property(key)               { register_property(model); }
+    template<size_t N> property(base_model* model, const char (&key)[N], const T&  value) requires (std::copy_constructible   <T>) : base_property(key), value(value) { register_property(model); }
+    template<size_t N> property(base_model* model, const char (&key)[N],       T&& value) requires (std::move_constructible   <T>) : base_property(key), value(value) { register_property(model); }
+
+    // Only the value is assigned, the target keeps its own key and becomes dirty like with any other value.
+    property& operator=(const property<T>&  other) requires (std::copy_constructible<T>) { value = other.value;            dirty = true; return *this; }
+    property& operator=(      property<T>&& other) requires (std::move_constructible<T>) { value = std::move(other.value); dirty = true; return *this; }
+    property& operator=(const          T &  val  ) requires (std::copy_constructible<T>) { value = val; dirty = true; return *this; }
+    property& operator=(               T && val  ) requires (std::move_constructible<T>) { value = val; dirty = true; return *this; }
+
+    template<class U> property& operator+=(U&& val) requires requires(T& t) { t += val; } { value += val; dirty = true; return *this; }
+    template<class U> property& operator-=(U&& val) requires requires(T& t) { t -= val; } { value -= val; dirty = true; return *this; }
+
+    property& operator++()    requires requires(T& t) { ++t; } {                  ++value; dirty = true; return *this; }
+    property& operator--()    requires requires(T& t) { --t; } {                  --value; dirty = true; return *this; }
+    T         operator++(int) requires requires(T& t) { t++; } { T old = value; ++value; dirty = true; return old;   }
+    T         operator--(int) requires requires(T& t) { t--; } { T old = value; --value; dirty = true; return old;   }
 
-    property& operator=(const property<T>&  value) requires (std::copy_constructible<T>) = default;
-    property& operator=(      property<T>&& value) requires (std::move_constructible<T>) = default;
-    property& operator=(const          T &  val  ) requires (std::copy_constructible<T>) { value = val; return *this; }
-    property& operator=(               T && val  ) requires (std::move_constructible<T>) { value = val; return *this; }
+    // Read-only so every change goes through a tracked operator, use modify() to change the value in place.
+    operator const T&() const { return value; }
 
-    operator T&() { return value; }
+    T& modify() { dirty = true; return value; }
 
     template<to_string_serializable S>
     bool operator==(S str) requires (to_string_serializable<T>) { return std::string(value) == str; }
@@ -2,7 +2,9 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <variant>
+#include <string_view>
 #include <concepts>
 
 #include "../tools/Container.hpp"
@@ -47,7 +49,7 @@ using serialized_t = std::variant<long long,
                                   std::vector<std::shared_ptr<base_model>>>;
 
 struct serialized {
-    enum {
+    enum type_t {
         integer,
         floating_point,
         boolean,
@@ -59,3 +61,34 @@ struct serialized {
     
     serialized_t value;
 };
+
+// Receives a property's value without it being copied into a serialized first, see base_property::visit().
+// Strings are only valid for the duration of the call.
+class serialized_visitor {
+public:
+    virtual void operator()(long long                                       value) = 0;
+    virtual void operator()(long double                                     value) = 0;
+    virtual void operator()(bool                                            value) = 0;
+    virtual void operator()(std::nullptr_t                                  value) = 0;
+    virtual void operator()(std::string_view                                value) = 0;
+    virtual void operator()(const std::shared_ptr<base_model>&              value) = 0;
+    virtual void operator()(const std::vector<std::shared_ptr<base_model>>& value) = 0;
+};
+
+// Adapts a callable taking any of the visited types, typically a generic lambda, to a serialized_visitor.
+template<class F>
+class serialized_visitor_for : public serialized_visitor {
+private:
+    F& callback;
+
+public:
+    serialized_visitor_for(F& callback) : callback(callback) { }
+
+    void operator()(long long                                       value) { callback(value); }
+    void operator()(long double                                     value) { callback(value); }
+    void operator()(bool                                            value) { callback(value); }
+    void operator()(std::nullptr_t                                  value) { callback(value); }
+    void operator()(std::string_view                                value) { callback(value); }
+    void operator()(const std::shared_ptr<base_model>&              value) { callback(value); }
+    void operator()(const std::vector<std::shared_ptr<base_model>>& value) { callback(value); }
+};
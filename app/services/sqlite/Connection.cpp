@@ -0,0 +1,75 @@
+#include "Connection.hpp"
+#include "../tools/Format.hpp"
+
+#include <stdexcept>
+
+namespace sqlite {
+    std::string connection::path      = "database.sqlite";
+    bool        connection::read_only = false;
+
+    connection::connection() {
+        int flags = SQLITE_OPEN_URI | SQLITE_OPEN_NOMUTEX | (read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+
+        if (sqlite3_open_v2(path.c_str(), &handle, flags, nullptr) != SQLITE_OK) {
+            std::string error = handle ? sqlite3_errmsg(handle) : "out of memory";
+
+            sqlite3_close(handle);
+
+            throw std::runtime_error(::format("Cannot open database \"{}\": {}", path, error));
+        }
+
+        // Writers take a lock on the whole file, wait for it rather than failing right away.
+        sqlite3_busy_timeout(handle, 5000);
+
+        // WAL lets readers on other connections carry on while a write is in progress.
+        if (!read_only) {
+            sqlite3_exec(handle, "PRAGMA journal_mode = WAL;", nullptr, nullptr, nullptr);
+        }
+    }
+
+    connection::~connection() {
+        sqlite3_close(handle);
+    }
+
+    connection& connection::get_instance() {
+        static thread_local connection instance;
+
+        return instance;
+    }
+
+    void connection::set_path(std::string path) {
+        connection::path = path;
+    }
+
+    void connection::set_read_only(bool enabled) {
+        read_only = enabled;
+    }
+
+    std::unique_ptr<statement> connection::prepare(const std::string& sql) {
+        return std::make_unique<statement>(handle, sql);
+    }
+
+    void connection::execute(const std::string& sql) {
+        char* error = nullptr;
+
+        if (sqlite3_exec(handle, sql.c_str(), nullptr, nullptr, &error) != SQLITE_OK) {
+            std::string message = error ? error : sqlite3_errmsg(handle);
+
+            sqlite3_free(error);
+
+            throw std::runtime_error(::format("Cannot run statement \"{}\": {}", sql, message));
+        }
+    }
+
+    bool connection::table_exists(const std::string& table_name) {
+        auto query = prepare("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?");
+
+        query->bind(1, serialized { .type = serialized::string, .value = table_name });
+
+        return query->step();
+    }
+
+    transaction connection::begin() {
+        return { *this };
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <sqlite3.h>
+
+#include <string>
+#include <memory>
+
+#include "Statement.hpp"
+#include "Transaction.hpp"
+
+namespace sqlite {
+    class connection {
+    private:
+        friend class transaction;
+
+        connection();
+
+        static std::string path;
+        static bool        read_only;
+
+        sqlite3* handle = nullptr;
+
+        // 0 outside of a transaction, 1 inside BEGIN, and one more for every SAVEPOINT opened within it.
+        size_t transactions = 0;
+
+    public:
+        ~connection();
+
+        connection(const connection& ) = delete;
+        connection(      connection&&) = delete;
+
+        // Every thread gets its own connection to the database file. Use a shared cache URI such as
+        // "file::memory:?cache=shared" to share an in-memory database between threads.
+        static connection& get_instance();
+
+        // Must be called before the first query is run.
+        static void set_path     (std::string path);
+        static void set_read_only(bool enabled);
+
+        std::unique_ptr<statement> prepare(const std::string& sql);
+
+        // Runs one or more statements without parameters.
+        void execute(const std::string& sql);
+
+        bool table_exists(const std::string& table_name);
+
+        // BEGIN, or a SAVEPOINT when this thread is already inside a transaction.
+        transaction begin();
+
+        bool in_transaction() const { return transactions > 0; }
+
+        sqlite3* get_handle() { return handle; }
+    };
+}
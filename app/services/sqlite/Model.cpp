@@ -0,0 +1,87 @@
+#include "Model.hpp"
+#include "Connection.hpp"
+#include "../tools/Format.hpp"
+
+#include <stdexcept>
+
+namespace sqlite {
+    void model::save() {
+        // Nothing changed since the model was loaded or last saved, skip the statement entirely.
+        if (created && !is_dirty()) {
+            return;
+        }
+
+        auto& conn = connection::get_instance();
+
+        if (!conn.table_exists(table_name())) {
+            throw std::runtime_error(::format("Cannot save model: table \"{}\" does not exist in the database.", table_name()));
+        }
+
+        if (created) {
+            std::string assignments;
+
+            for (auto& property : sorted_properties()) {
+                if (property.second->is_dirty() && property.first != "id") {
+                    assignments += ::format("{}\"{}\" = ?", assignments.empty() ? "" : ", ", property.first);
+                }
+            }
+
+            if (!assignments.empty()) {
+                auto update = conn.prepare(::format("UPDATE \"{}\" SET {} WHERE \"id\" = ?", table_name(), assignments));
+                int  index  = 1;
+
+                for (auto& property : sorted_properties()) {
+                    if (property.second->is_dirty() && property.first != "id") {
+                        update->bind(index++, *property.second);
+                    }
+                }
+
+                update->bind(index, id);
+                update->execute();
+            }
+        } else {
+            std::string columns;
+            std::string placeholders;
+
+            for (auto& property : sorted_properties()) {
+                columns      += ::format("{}\"{}\"", columns.empty() ? "" : ", ", property.first);
+                placeholders += placeholders.empty() ? "?" : ", ?";
+            }
+
+            auto insert = conn.prepare(::format("INSERT INTO \"{}\" ({}) VALUES ({})", table_name(), columns, placeholders));
+            int  index  = 1;
+
+            for (auto& property : sorted_properties()) {
+                // A NULL id lets SQLite pick the next rowid.
+                if (property.first == "id" && id == 0) {
+                    insert->bind(index++, serialized { .type = serialized::null, .value = nullptr });
+                } else {
+                    insert->bind(index++, *property.second);
+                }
+            }
+
+            insert->execute();
+
+            id      = sqlite3_last_insert_rowid(conn.get_handle());
+            created = true;
+        }
+
+        mark_clean();
+    }
+
+    void model::remove() {
+        if (!created)
+            return;
+
+        auto& conn = connection::get_instance();
+
+        if (!conn.table_exists(table_name())) {
+            throw std::runtime_error(::format("Cannot remove model: table \"{}\" does not exist in the database.", table_name()));
+        }
+
+        auto statement = conn.prepare(::format("DELETE FROM \"{}\" WHERE \"id\" = ?", table_name()));
+
+        statement->bind(1, id);
+        statement->execute();
+    }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../database/Model.hpp"
+
+namespace sqlite {
+    class model : public db::model {
+    public:
+        void save();
+        void remove();
+
+        db::table* get_table() { return nullptr; }
+    };
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "Connection.hpp"
+#include "Model.hpp"
+#include "Table.hpp"
@@ -0,0 +1,125 @@
+#include "Statement.hpp"
+#include "../tools/Format.hpp"
+
+#include <stdexcept>
+
+namespace sqlite {
+    statement::statement(sqlite3* db, const std::string& sql) : db(db), sql(sql) {
+        check(sqlite3_prepare_v2(db, sql.c_str(), (int)sql.size(), &handle, nullptr), "prepare");
+    }
+
+    statement::~statement() {
+        sqlite3_finalize(handle);
+    }
+
+    void statement::check(int result, const char* action) const {
+        if (result != SQLITE_OK && result != SQLITE_ROW && result != SQLITE_DONE) {
+            throw std::runtime_error(::format("Cannot {} statement \"{}\": {}", action, sql, sqlite3_errmsg(db)));
+        }
+    }
+
+    statement& statement::bind(int index, const serialized& value) {
+        int result;
+
+        switch (value.type) {
+            case serialized::integer:        result = sqlite3_bind_int64 (handle, index, std::get<long long>(value.value));                   break;
+            case serialized::floating_point: result = sqlite3_bind_double(handle, index, (double)std::get<long double>(value.value));         break;
+            case serialized::boolean:        result = sqlite3_bind_int   (handle, index, std::get<bool>(value.value) ? 1 : 0);                break;
+            case serialized::string:         result = sqlite3_bind_text  (handle, index, std::get<std::string>(value.value).c_str(),
+                                                                                         (int)std::get<std::string>(value.value).size(), SQLITE_TRANSIENT); break;
+            default:                         result = sqlite3_bind_null  (handle, index);                                                 break;
+        }
+
+        check(result, "bind parameter of");
+
+        return *this;
+    }
+
+    statement& statement::bind(int index, base_property& property) {
+        int result = SQLITE_OK;
+
+        property.visit([&](auto&& value) {
+            using T = std::decay_t<decltype(value)>;
+
+            if      constexpr (std::same_as<T, long long>)        result = sqlite3_bind_int64 (handle, index, value);
+            else if constexpr (std::same_as<T, long double>)      result = sqlite3_bind_double(handle, index, (double)value);
+            else if constexpr (std::same_as<T, bool>)             result = sqlite3_bind_int   (handle, index, value ? 1 : 0);
+            else if constexpr (std::same_as<T, std::string_view>) result = sqlite3_bind_text  (handle, index, value.data(), (int)value.size(), SQLITE_TRANSIENT);
+            else                                                  result = sqlite3_bind_null  (handle, index);
+        });
+
+        check(result, "bind parameter of");
+
+        return *this;
+    }
+
+    bool statement::step() {
+        int result = sqlite3_step(handle);
+
+        check(result, "run");
+
+        return result == SQLITE_ROW;
+    }
+
+    size_t statement::execute() {
+        while (step());
+
+        return sqlite3_changes(db);
+    }
+
+    void statement::reset() {
+        sqlite3_reset(handle);
+        sqlite3_clear_bindings(handle);
+    }
+
+    int statement::column_count() const {
+        return sqlite3_column_count(handle);
+    }
+
+    std::string statement::column_name(int index) const {
+        return sqlite3_column_name(handle, index);
+    }
+
+    serialized statement::column(int index) const {
+        switch (sqlite3_column_type(handle, index)) {
+            case SQLITE_INTEGER: return serialized { .type = serialized::integer,        .value = (long long)  sqlite3_column_int64 (handle, index) };
+            case SQLITE_FLOAT:   return serialized { .type = serialized::floating_point, .value = (long double)sqlite3_column_double(handle, index) };
+            case SQLITE_NULL:    return serialized { .type = serialized::null,           .value = nullptr };
+
+            default: {
+                auto text = (const char*)sqlite3_column_text(handle, index);
+
+                return serialized { .type = serialized::string, .value = std::string(text, sqlite3_column_bytes(handle, index)) };
+            }
+        }
+    }
+
+    std::string to_sql_literals(const std::string& value) {
+        std::string result;
+
+        for (size_t i = 0; i < value.size(); i++) {
+            if (value[i] != '"') {
+                result += value[i];
+                continue;
+            }
+
+            result += '\'';
+
+            for (i++; i < value.size() && value[i] != '"'; i++) {
+                if (value[i] == '\\' && i + 1 < value.size()) {
+                    i++;
+                }
+
+                if (value[i] == '\'') {
+                    result += '\'';
+                }
+
+                result += value[i];
+            }
+
+            result += '\'';
+        }
+
+        return result;
+    }
+}
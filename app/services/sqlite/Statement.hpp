@@ -0,0 +1,50 @@
+#pragma once
+
+#include <sqlite3.h>
+
+#include "../serialization/Serializable.hpp"
+#include "../serialization/Property.hpp"
+
+#include <string>
+
+namespace sqlite {
+    // Prepared statement, finalized when it goes out of scope. Parameters are numbered from 1 and columns
+    // from 0, as in the SQLite C API.
+    class statement {
+    private:
+        sqlite3*      db;
+        sqlite3_stmt* handle = nullptr;
+        std::string   sql;
+
+        void check(int result, const char* action) const;
+
+    public:
+        statement(sqlite3* db, const std::string& sql);
+        ~statement();
+
+        statement(const statement& ) = delete;
+        statement(      statement&&) = delete;
+
+        statement& bind(int index, const serialized& value);
+
+        // Binds a property's value without copying it into a serialized first.
+        statement& bind(int index, base_property& property);
+
+        // Runs the statement up to the next row, returns false once it is done.
+        bool step();
+
+        // Runs the statement to completion and returns the number of rows it changed.
+        size_t execute();
+
+        // Makes the statement ready to run again with new parameters.
+        void reset();
+
+        int         column_count() const;
+        std::string column_name(int index) const;
+        serialized  column(int index) const;
+    };
+
+    // Turns the double-quoted string literals of a where value (see db::to_query_value) into single-quoted
+    // ones, since SQLite reads double quotes as identifiers.
+    std::string to_sql_literals(const std::string& value);
+}
@@ -0,0 +1,551 @@
+#pragma once
+
+#include "../database/Table.hpp"
+#include "../tools/Container.hpp"
+
+#include "Model.hpp"
+#include "Connection.hpp"
+
+#include <map>
+#include <cctype>
+#include <format>
+#include <algorithm>
+#include <stdexcept>
+
+namespace sqlite {
+    template<class Model>
+    class table : public db::table,
+                         base_serializer {
+    protected:
+        // Older SQLite builds reject statements with more parameters than this.
+        static constexpr size_t max_parameters = 999;
+
+        static std::string where_clause(const std::vector<db::where_query_t>& wheres) {
+            std::string clause;
+
+            for (auto& condition : wheres) {
+                clause += std::format("{}{}", clause.empty() ? " WHERE " : " AND ", db::to_sql(condition, to_sql_literals));
+            }
+
+            return clause;
+        }
+
+        static std::string limit_clause(size_t limit, size_t offset) {
+            if (limit == (size_t)-1 && offset == 0) {
+                return "";
+            }
+
+            // A negative LIMIT means no limit in SQLite.
+            return std::format(" LIMIT {} OFFSET {}", limit == (size_t)-1 ? -1 : (long long)limit, offset);
+        }
+
+        std::unique_ptr<statement> prepare_select(const std::vector<db::where_query_t>&    wheres,
+                                                  const std::vector<db::order_by_query_t>& order_bys,
+                                                  size_t                                   limit,
+                                                  size_t                                   offset,
+                                                  const std::vector<std::string>&          selected_columns) const {
+            auto& conn = connection::get_instance();
+
+            if (!conn.table_exists(name)) {
+                throw std::runtime_error(std::format("Cannot select models: table \"{}\" does not exist in the database.", name));
+            }
+
+            std::string projection;
+
+            for (auto& column : selected_columns) {
+                projection += std::format("{}\"{}\"", projection.empty() ? "" : ", ", column);
+            }
+
+            std::string sql = std::format("SELECT {} FROM \"{}\"{}", projection.empty() ? "*" : projection, name, where_clause(wheres));
+
+            for (size_t i = 0; i < order_bys.size(); i++) {
+                sql += std::format("{}{} {}", i == 0 ? " ORDER BY " : ", ", order_bys[i].key, (order_bys[i].asc ? "ASC" : "DESC"));
+            }
+
+            return conn.prepare(sql + limit_clause(limit, offset));
+        }
+
+        std::vector<std::shared_ptr<db::model>> get(std::vector<db::where_query_t>    wheres,
+                                                    std::vector<db::order_by_query_t> order_bys,
+                                                    size_t                            limit,
+                                                    size_t                            offset,
+                                                    std::vector<std::string>          selected_columns) const {
+            std::vector<std::shared_ptr<db::model>> models;
+
+            get_into(wheres, order_bys, limit, offset, selected_columns, [&]() -> db::model& {
+                return *models.emplace_back(std::make_shared<Model>());
+            });
+
+            return models;
+        }
+
+        void get_into(std::vector<db::where_query_t>     wheres,
+                      std::vector<db::order_by_query_t>  order_bys,
+                      size_t                             limit,
+                      size_t                             offset,
+                      std::vector<std::string>           selected_columns,
+                      const std::function<db::model&()>& next) const {
+            auto select = prepare_select(wheres, order_bys, limit, offset, selected_columns);
+
+            std::vector<std::string> columns;
+
+            for (int i = 0; i < select->column_count(); i++) {
+                columns.push_back(select->column_name(i));
+            }
+
+            auto shared = share_columns(selected_columns);
+
+            for (bool first = true; select->step(); first = false) {
+                db::model& m = next();
+
+                if (first && !dynamic_cast<Model*>(&m)) {
+                    throw std::logic_error(std::format("Cannot select models: the models of table \"{}\" are of another type.", name));
+                }
+
+                auto properties = get_properties(m);
+
+                set_selected_columns(m, shared);
+                set_created(m);
+
+                for (size_t i = 0; i < columns.size(); i++) {
+                    auto property = properties.find(columns[i]);
+
+                    if (property != properties.end()) {
+                        property->second->deserialize_value(select->column((int)i));
+                    }
+                }
+
+                m.mark_clean();
+            }
+        }
+
+        db::column_set get_columnar(std::vector<db::where_query_t>    wheres,
+                                    std::vector<db::order_by_query_t> order_bys,
+                                    size_t                            limit,
+                                    size_t                            offset,
+                                    std::vector<std::string>          selected_columns) const {
+            auto select = prepare_select(wheres, order_bys, limit, offset, selected_columns);
+
+            std::vector<std::string> names;
+
+            for (int i = 0; i < select->column_count(); i++) {
+                names.push_back(select->column_name(i));
+            }
+
+            db::column_set          columns(names);
+            std::vector<serialized> values(names.size());
+
+            while (select->step()) {
+                for (size_t i = 0; i < names.size(); i++) {
+                    values[i] = select->column((int)i);
+                }
+
+                columns.push_row(values);
+            }
+
+            return columns;
+        }
+
+        size_t remove(std::vector<db::where_query_t>    wheres,
+                      std::vector<db::order_by_query_t> order_bys,
+                      size_t                            limit) const {
+            auto& conn = connection::get_instance();
+
+            if (!conn.table_exists(name)) {
+                throw std::runtime_error(std::format("Cannot remove models: table \"{}\" does not exist in the database.", name));
+            }
+
+            // DELETE ... LIMIT is a compile-time option in SQLite, so limited deletes go through the rowid.
+            if (!order_bys.empty() || limit != (size_t)-1) {
+                std::string order;
+
+                for (size_t i = 0; i < order_bys.size(); i++) {
+                    order += std::format("{}{} {}", i == 0 ? " ORDER BY " : ", ", order_bys[i].key, (order_bys[i].asc ? "ASC" : "DESC"));
+                }
+
+                return conn.prepare(std::format("DELETE FROM \"{}\" WHERE rowid IN (SELECT rowid FROM \"{}\"{}{}{})",
+                                                name, name, where_clause(wheres), order, limit_clause(limit, 0)))->execute();
+            }
+
+            return conn.prepare(std::format("DELETE FROM \"{}\"{}", name, where_clause(wheres)))->execute();
+        }
+
+        std::shared_ptr<db::joined_table> join(const base_table& that,
+                                               std::string this_key,
+                                               std::string that_key,
+                                               db::join_mode_t mode) const {
+            throw std::runtime_error("Cannot join tables: joins are not supported by the SQLite driver yet.");
+        }
+
+    public:
+        using model_type = Model;
+        using db::base_table::join;
+
+        // Ids per DELETE in remove(models), capped at max_parameters. Inserts and updates bind one row at a time.
+        size_t batch_size = 1000;
+
+        table() : db::table(Model { }) { };
+        table(const table& ) = default;
+        table(      table&&) = default;
+
+        table& operator=(const table& ) = default;
+        table& operator=(      table&&) = default;
+
+        // Inserts the models in a single transaction, reusing one prepared statement for every row.
+        void insert(std::vector<std::shared_ptr<db::model>> models) {
+            auto& conn = connection::get_instance();
+
+            if (!conn.table_exists(name)) {
+                throw std::runtime_error(std::format("Cannot insert models: table \"{}\" does not exist in the database.", name));
+            }
+
+            if (models.empty()) {
+                return;
+            }
+
+            std::string columns;
+            std::string placeholders;
+
+            for (auto& property : get_sorted_properties(*models.front())) {
+                columns      += std::format("{}\"{}\"", columns.empty() ? "" : ", ", property.first);
+                placeholders += placeholders.empty() ? "?" : ", ?";
+            }
+
+            auto transaction = conn.begin();
+            auto statement   = conn.prepare(std::format("INSERT INTO \"{}\" ({}) VALUES ({})", name, columns, placeholders));
+
+            for (auto& model : models) {
+                int index = 1;
+
+                for (auto& property : get_sorted_properties(*model)) {
+                    // A NULL id lets SQLite pick the next rowid.
+                    if (property.first == "id" && model->id == 0) {
+                        statement->bind(index++, serialized { .type = serialized::null, .value = nullptr });
+                    } else {
+                        statement->bind(index++, *property.second);
+                    }
+                }
+
+                statement->execute();
+                statement->reset();
+
+                model->id = sqlite3_last_insert_rowid(conn.get_handle());
+
+                set_created(*model);
+                model->mark_clean();
+            }
+
+            transaction.commit();
+        }
+
+        // Inserts the models, or updates the existing rows when they collide on the primary key or a unique
+        // index, through INSERT ... ON CONFLICT DO UPDATE.
+        void upsert(std::vector<std::shared_ptr<db::model>> models) {
+            auto& conn = connection::get_instance();
+
+            std::vector<std::shared_ptr<db::model>> keyed;
+            std::vector<std::shared_ptr<db::model>> unkeyed;
+
+            for (auto& model : models) {
+                (model->id == 0 ? unkeyed : keyed).push_back(model);
+            }
+
+            insert(unkeyed);
+
+            if (keyed.empty()) {
+                return;
+            }
+
+            std::string columns;
+            std::string placeholders;
+            std::string assignments;
+
+            for (auto& property : get_sorted_properties(*keyed.front())) {
+                columns      += std::format("{}\"{}\"", columns.empty() ? "" : ", ", property.first);
+                placeholders += placeholders.empty() ? "?" : ", ?";
+
+                if (property.first != "id") {
+                    assignments += std::format("{}\"{}\" = excluded.\"{}\"", assignments.empty() ? "" : ", ", property.first, property.first);
+                }
+            }
+
+            auto transaction = conn.begin();
+            auto statement   = conn.prepare(std::format("INSERT INTO \"{}\" ({}) VALUES ({}) ON CONFLICT DO {}",
+                                                        name, columns, placeholders, assignments.empty() ? "NOTHING" : "UPDATE SET " + assignments));
+
+            for (auto& model : keyed) {
+                int index = 1;
+
+                for (auto& property : get_sorted_properties(*model)) {
+                    statement->bind(index++, *property.second);
+                }
+
+                statement->execute();
+                statement->reset();
+
+                set_created(*model);
+                model->mark_clean();
+            }
+
+            transaction.commit();
+        }
+
+        // Updates the changed columns of every model in a single transaction. Prepared statements are
+        // reused between models that changed the same columns.
+        void update(std::vector<std::shared_ptr<db::model>> models) {
+            auto& conn = connection::get_instance();
+
+            std::map<std::string, std::unique_ptr<statement>> statements;
+
+            auto transaction = conn.begin();
+
+            for (auto& model : models) {
+                std::string assignments;
+
+                for (auto& property : get_sorted_properties(*model)) {
+                    if (property.second->is_dirty() && property.first != "id") {
+                        assignments += std::format("{}\"{}\" = ?", assignments.empty() ? "" : ", ", property.first);
+                    }
+                }
+
+                if (assignments.empty()) {
+                    continue;
+                }
+
+                auto& statement = statements[assignments];
+
+                if (!statement) {
+                    statement = conn.prepare(std::format("UPDATE \"{}\" SET {} WHERE \"id\" = ?", name, assignments));
+                }
+
+                int index = 1;
+
+                for (auto& property : get_sorted_properties(*model)) {
+                    if (property.second->is_dirty() && property.first != "id") {
+                        statement->bind(index++, *property.second);
+                    }
+                }
+
+                statement->bind(index, model->id);
+                statement->execute();
+                statement->reset();
+
+                model->mark_clean();
+            }
+
+            transaction.commit();
+        }
+
+        void remove(std::vector<std::shared_ptr<db::model>> models) const {
+            auto& conn = connection::get_instance();
+
+            if (!conn.table_exists(name)) {
+                throw std::runtime_error(std::format("Cannot remove models: table \"{}\" does not exist in the database.", name));
+            }
+
+            size_t chunk = std::max<size_t>(1, std::min(batch_size, max_parameters));
+
+            for (size_t first = 0; first < models.size(); first += chunk) {
+                size_t last = std::min(first + chunk, models.size());
+
+                std::string placeholders;
+
+                for (size_t i = first; i < last; i++) {
+                    placeholders += placeholders.empty() ? "?" : ", ?";
+                }
+
+                auto statement = conn.prepare(std::format("DELETE FROM \"{}\" WHERE \"id\" IN ({})", name, placeholders));
+
+                for (size_t i = first; i < last; i++) {
+                    statement->bind((int)(i - first + 1), models[i]->id);
+                }
+
+                statement->execute();
+            }
+        }
+
+        // define_schema() of a default-constructed model, plus SQLite storage classes for undeclared properties.
+        db::schema get_schema() const {
+            Model m;
+            db::schema s;
+
+            m.define_schema(s);
+
+            db::schema complete;
+
+            complete.indexes = s.indexes;
+
+            for (auto& property : get_sorted_properties(m)) {
+                if (auto declared = s.find_column(property.first)) {
+                    complete.columns.push_back(*declared);
+
+                    continue;
+                }
+
+                std::string type;
+
+                switch (property.second->serialized_type()) {
+                    case serialized::integer:        type = "INTEGER"; break;
+                    case serialized::floating_point: type = "REAL";    break;
+                    case serialized::boolean:        type = "INTEGER"; break;
+                    case serialized::string:         type = "TEXT";    break;
+
+                    // Nested models are not stored in a column.
+                    default: continue;
+                }
+
+                complete.columns.push_back({ .name = property.first, .type = type, .inferred = true });
+            }
+
+            return complete;
+        }
+
+        // Index names are global in SQLite, so they are prefixed with the table name.
+        std::string index_name(const db::index_definition& index) const {
+            return std::format("{}_{}", name, index.name);
+        }
+
+        std::string index_sql(const db::index_definition& index) const {
+            std::string columns;
+
+            for (auto& column : index.columns) {
+                columns += std::format("{}\"{}\"", columns.empty() ? "" : ", ", column);
+            }
+
+            return std::format("CREATE {}INDEX IF NOT EXISTS \"{}\" ON \"{}\" ({})", index.unique ? "UNIQUE " : "", index_name(index), name, columns);
+        }
+
+        // Columns added to an existing table need a default for the rows already in it.
+        static std::string default_sql(const db::column_definition& column) {
+            std::string type = column.type;
+
+            std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return std::toupper(c); });
+
+            bool text = type.find("CHAR") != type.npos || type.find("TEXT") != type.npos || type.find("CLOB") != type.npos;
+
+            return text ? " DEFAULT ''" : " DEFAULT 0";
+        }
+
+        std::string column_sql(const db::column_definition& column) const {
+            // An INTEGER PRIMARY KEY is an alias for the rowid, which SQLite assigns on insert.
+            if (column.name == "id") {
+                return "\"id\" INTEGER PRIMARY KEY";
+            }
+
+            return std::format("\"{}\" {}{}", column.name, column.type, column.nullable ? "" : " NOT NULL");
+        }
+
+        void create() const {
+            auto& conn   = connection::get_instance();
+            auto  schema = get_schema();
+
+            std::string definitions;
+
+            for (auto& column : schema.columns) {
+                definitions += std::format("{}{}", definitions.empty() ? "" : ", ", column_sql(column));
+            }
+
+            auto transaction = conn.begin();
+
+            conn.execute(std::format("CREATE TABLE IF NOT EXISTS \"{}\" ({})", name, definitions));
+
+            for (auto& index : schema.indexes) {
+                conn.execute(index_sql(index));
+            }
+
+            transaction.commit();
+        }
+
+        void destroy() const {
+            connection::get_instance().execute(std::format("DROP TABLE IF EXISTS \"{}\"", name));
+        }
+
+        void clear() const {
+            auto& conn = connection::get_instance();
+
+            if (!conn.table_exists(name)) {
+                throw std::runtime_error(std::format("Cannot remove models: table \"{}\" does not exist in the database.", name));
+            }
+
+            conn.execute(std::format("DELETE FROM \"{}\"", name));
+        }
+
+        // Adds missing columns and brings the indexes in line with the schema. SQLite cannot change the
+        // type of a column in place, so columns that already exist are left as they are.
+        void migrate(bool drop_columns = false) const {
+            auto& conn = connection::get_instance();
+
+            if (!conn.table_exists(name)) {
+                create();
+
+                return;
+            }
+
+            auto schema = get_schema();
+
+            std::vector<std::string> columns;
+
+            auto column_rows = conn.prepare(std::format("PRAGMA table_info(\"{}\")", name));
+
+            while (column_rows->step()) {
+                columns.push_back(std::get<std::string>(column_rows->column(1).value));
+            }
+
+            std::map<std::string, db::index_definition> indexes;
+
+            auto index_rows = conn.prepare(std::format("SELECT name, \"unique\" FROM pragma_index_list('{}') WHERE origin = 'c'", name));
+
+            while (index_rows->step()) {
+                auto  index_name = std::get<std::string>(index_rows->column(0).value);
+                auto& index      = indexes[index_name];
+
+                index.name   = index_name;
+                index.unique = std::get<long long>(index_rows->column(1).value) != 0;
+
+                auto index_columns = conn.prepare(std::format("SELECT name FROM pragma_index_info('{}') ORDER BY seqno", index_name));
+
+                while (index_columns->step()) {
+                    index.columns.push_back(std::get<std::string>(index_columns->column(0).value));
+                }
+            }
+
+            auto transaction = conn.begin();
+
+            for (auto& [existing_name, index] : indexes) {
+                auto declared = std::find_if(schema.indexes.begin(), schema.indexes.end(), [&](auto& i) { return index_name(i) == existing_name; });
+
+                if (declared == schema.indexes.end() || declared->columns != index.columns || declared->unique != index.unique) {
+                    conn.execute(std::format("DROP INDEX \"{}\"", existing_name));
+                }
+            }
+
+            for (auto& column : schema.columns) {
+                if (!contains(columns, column.name)) {
+                    conn.execute(std::format("ALTER TABLE \"{}\" ADD COLUMN {}{}", name, column_sql(column), column.nullable ? "" : default_sql(column)));
+                }
+            }
+
+            if (drop_columns) {
+                for (auto& column : columns) {
+                    if (!schema.find_column(column)) {
+                        conn.execute(std::format("ALTER TABLE \"{}\" DROP COLUMN \"{}\"", name, column));
+                    }
+                }
+            }
+
+            for (auto& index : schema.indexes) {
+                conn.execute(index_sql(index));
+            }
+
+            transaction.commit();
+        }
+
+        std::shared_ptr<db::model> new_model() const {
+            return std::make_shared<Model>();
+        }
+
+        std::shared_ptr<const db::base_table> copy() const {
+            return std::make_shared<table>(*this);
+        }
+    };
+}
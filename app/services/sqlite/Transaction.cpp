@@ -0,0 +1,55 @@
+#include "Connection.hpp"
+#include "Transaction.hpp"
+#include "../tools/Format.hpp"
+
+#include <stdexcept>
+
+namespace sqlite {
+    transaction::transaction(connection& conn) : conn(conn), level(conn.transactions + 1) {
+        if (level == 1) {
+            conn.execute("BEGIN");
+        } else {
+            savepoint = ::format("webcxx_savepoint_{}", level);
+            conn.execute(::format("SAVEPOINT {}", savepoint));
+        }
+
+        conn.transactions++;
+    }
+
+    transaction::~transaction() {
+        if (finished) {
+            return;
+        }
+
+        // Also runs while unwinding from an exception, so a failing ROLLBACK is swallowed here.
+        try {
+            rollback();
+        } catch (std::exception& e) { }
+    }
+
+    void transaction::finish(const char* action) {
+        if (finished) {
+            throw std::logic_error(::format("Cannot {} transaction: it has already ended.", action));
+        }
+
+        if (conn.transactions != level) {
+            throw std::logic_error(::format("Cannot {} transaction: a nested transaction is still open.", action));
+        }
+
+        finished = true;
+        conn.transactions--;
+    }
+
+    void transaction::commit() {
+        finish("commit");
+
+        conn.execute(level == 1 ? "COMMIT" : ::format("RELEASE {}", savepoint));
+    }
+
+    void transaction::rollback() {
+        finish("roll back");
+
+        // ROLLBACK TO leaves the savepoint open, release it as well.
+        conn.execute(level == 1 ? "ROLLBACK" : ::format("ROLLBACK TO {}; RELEASE {}", savepoint, savepoint));
+    }
+}
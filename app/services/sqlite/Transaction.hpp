@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+#include "../database/Transaction.hpp"
+
+namespace sqlite {
+    class connection;
+
+    // BEGIN ... COMMIT on the thread's connection. Calling begin() again before it ends opens a SAVEPOINT
+    // that can be released or rolled back to independently. Destroying an unfinished one rolls it back.
+    class transaction : db::transaction {
+    private:
+        friend class connection;
+
+        transaction(connection& conn);
+
+        connection& conn;
+
+        // The BEGIN is level 1, each SAVEPOINT inside it one more.
+        size_t      level;
+        std::string savepoint;
+        bool        finished = false;
+
+        void finish(const char* action);
+
+    public:
+        transaction(const transaction& ) = delete;
+        transaction(      transaction&&) = delete;
+
+        ~transaction();
+
+        void commit();
+        void rollback();
+    };
+}
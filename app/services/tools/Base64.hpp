@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <stdexcept>
+
+// URL-safe base64 (RFC 4648 §5) without padding, suitable for tokens embedded in URLs and JSON.
+inline std::string encode_base64url(std::string_view data) {
+    constexpr const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    std::string output;
+    output.reserve((data.size() + 2) / 3 * 4);
+
+    unsigned int buffer = 0;
+    int          bits   = 0;
+
+    for (unsigned char c : data) {
+        buffer = (buffer << 8) | c;
+        bits  += 8;
+
+        while (bits >= 6) {
+            bits -= 6;
+            output += alphabet[(buffer >> bits) & 0x3F];
+        }
+    }
+
+    if (bits > 0) {
+        output += alphabet[(buffer << (6 - bits)) & 0x3F];
+    }
+
+    return output;
+}
+
+inline std::string decode_base64url(std::string_view data) {
+    std::string output;
+    output.reserve(data.size() * 3 / 4);
+
+    unsigned int buffer = 0;
+    int          bits   = 0;
+
+    for (char c : data) {
+        unsigned int value;
+
+        if      (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '-')             value = 62;
+        else if (c == '_')             value = 63;
+        else throw std::invalid_argument("Invalid character in base64url string.");
+
+        buffer = (buffer << 6) | value;
+        bits  += 6;
+
+        if (bits >= 8) {
+            bits -= 8;
+            output += (char)((buffer >> bits) & 0xFF);
+        }
+    }
+
+    return output;
+}
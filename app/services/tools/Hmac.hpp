@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// SHA-256 (FIPS 180-4), enough to sign small tokens without pulling in a crypto library.
+inline std::string sha256(std::string_view data) {
+    constexpr uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    std::array<uint32_t, 8> h = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    auto rotate = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+
+    // Pad to a multiple of 64 bytes: a 1 bit, zeros and the message length in bits.
+    std::string message(data);
+
+    message += (char)0x80;
+
+    while (message.size() % 64 != 56) {
+        message += (char)0;
+    }
+
+    for (int i = 7; i >= 0; i--) {
+        message += (char)(((uint64_t)data.size() * 8) >> (i * 8));
+    }
+
+    for (size_t block = 0; block < message.size(); block += 64) {
+        uint32_t w[64];
+
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t)(unsigned char)message[block + i * 4]     << 24 |
+                   (uint32_t)(unsigned char)message[block + i * 4 + 1] << 16 |
+                   (uint32_t)(unsigned char)message[block + i * 4 + 2] <<  8 |
+                   (uint32_t)(unsigned char)message[block + i * 4 + 3];
+        }
+
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotate(w[i - 15],  7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >>  3);
+            uint32_t s1 = rotate(w[i -  2], 17) ^ rotate(w[i -  2], 19) ^ (w[i -  2] >> 10);
+
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        auto [a, b, c, d, e, f, g, hh] = h;
+
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = hh + (rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            uint32_t t2 = (rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+
+            hh = g; g = f; f = e; e = d + t1;
+            d  = c; c = b; b = a; a = t1 + t2;
+        }
+
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+        h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    }
+
+    std::string digest;
+
+    for (uint32_t word : h) {
+        for (int i = 3; i >= 0; i--) {
+            digest += (char)(word >> (i * 8));
+        }
+    }
+
+    return digest;
+}
+
+// HMAC-SHA-256 (RFC 2104) of data under key, as 32 raw bytes.
+inline std::string hmac_sha256(std::string_view key, std::string_view data) {
+    std::string block = key.size() > 64 ? sha256(key) : std::string(key);
+
+    block.resize(64, (char)0);
+
+    std::string inner = block, outer = block;
+
+    for (size_t i = 0; i < 64; i++) {
+        inner[i] ^= 0x36;
+        outer[i] ^= 0x5c;
+    }
+
+    return sha256(outer + sha256(inner + std::string(data)));
+}
+
+// Compares two strings in time independent of where they differ, for checking signatures.
+inline bool equals_constant_time(std::string_view lhs, std::string_view rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+
+    unsigned char difference = 0;
+
+    for (size_t i = 0; i < lhs.size(); i++) {
+        difference |= lhs[i] ^ rhs[i];
+    }
+
+    return difference == 0;
+}
@@ -0,0 +1,103 @@
+#include "Test.hpp"
+
+SOURCE("app/services/sqlite/Connection.cpp")
+SOURCE("app/services/sqlite/Model.cpp")
+SOURCE("app/services/sqlite/Statement.cpp")
+SOURCE("app/services/sqlite/Transaction.cpp")
+SOURCE("app/services/database/Columnar.cpp")
+SOURCE("app/services/database/Relation.cpp")
+SOURCE("app/services/database/Table.cpp")
+SOURCE("app/services/serialization/Model.cpp")
+LIBRARY("sqlite3")
+
+#include "../services/sqlite/SQLite.hpp"
+
+#include <set>
+#include <thread>
+#include <filesystem>
+
+struct task : sqlite::model {
+    property<std::string> title { this, "title" };
+
+    std::string table_name() const { return "async_tasks"; }
+};
+
+// Every thread opens its own SQLite connection, so the tests share a file instead of a memory database.
+static std::string database_path() {
+    return (std::filesystem::temp_directory_path() / "webcxx_async_test.db").string();
+}
+
+class AsyncSuite : public TestSuite {
+public:
+    void setup() override {
+        std::filesystem::remove(database_path());
+
+        sqlite::connection::set_path(database_path());
+
+        sqlite::table<task> tasks;
+
+        tasks.destroy();
+        tasks.create();
+
+        for (auto title : { "a", "b", "c" }) {
+            task t;
+
+            t.title = title;
+            t.save();
+        }
+    }
+
+    void cleanup() override {
+        std::filesystem::remove(database_path());
+    }
+};
+
+COLLECTION(AsyncSuite)
+    IT("runs a query built on a temporary table", {
+        auto future = sqlite::table<task>().where("title", std::string("b"), "=").get_async();
+
+        auto found = future.get();
+
+        Expect(found.size()).toBe((size_t)1);
+        Expect((const std::string&)std::static_pointer_cast<task>(found.front())->title).toBe(std::string("b"));
+    })
+
+    IT("saves a model on a worker", {
+        task t;
+
+        t.title = "d";
+        t.save_async().get();
+
+        Expect(sqlite::table<task>().all().size()).toBe((size_t)4);
+    })
+
+    IT("runs every task on one of async_workers threads", {
+        std::vector<std::future<std::thread::id>> futures;
+
+        for (size_t i = 0; i < 4 * db::async_workers; i++) {
+            futures.push_back(db::async([] { return std::this_thread::get_id(); }));
+        }
+
+        std::set<std::thread::id> threads;
+
+        for (auto& f : futures) {
+            threads.insert(f.get());
+        }
+
+        Expect(threads.size() <= db::async_workers).toBeTrue();
+        Expect(threads.contains(std::this_thread::get_id())).toBeFalse();
+    })
+
+    IT("carries the caller's request to the worker", {
+        db::request::current()->written = true;
+
+        bool written = db::async([] { return db::request::current()->written.load(); }).get();
+
+        db::request::reset();
+
+        bool reset = db::async([] { return db::request::current()->written.load(); }).get();
+
+        Expect(written).toBeTrue();
+        Expect(reset).toBeFalse();
+    })
+END()
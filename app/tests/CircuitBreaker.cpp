@@ -0,0 +1,173 @@
+#include "Test.hpp"
+
+SOURCE("app/services/rest/Resilience.cpp")
+LIBRARY("curl")
+
+#include "../services/rest/Resilience.hpp"
+#include "../services/rest/Rest.hpp"
+
+#include <thread>
+#include <filesystem>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using rest::circuit_breaker;
+
+static const std::string origin = "https://upstream.test";
+
+class CircuitBreakerSuite : public TestSuite {
+public:
+    void beforeEach() override {
+        circuit_breaker::failure_threshold = 2;
+        circuit_breaker::open_ms           = 50;
+        circuit_breaker::directory         = "";
+
+        circuit_breaker::reset();
+    }
+
+    void cleanup() override {
+        std::filesystem::remove_all(directory());
+
+        circuit_breaker::directory = "";
+    }
+
+    static std::string directory() {
+        return (std::filesystem::temp_directory_path() / "webcxx_circuit_test").string();
+    }
+};
+
+static void fail(size_t times) {
+    for (size_t i = 0; i < times; i++) {
+        circuit_breaker::allow(origin).record(false);
+    }
+}
+
+static bool rejected() {
+    try {
+        auto permit = circuit_breaker::allow(origin);
+
+        permit.record(true);
+    } catch (rest::rest_error&) {
+        return true;
+    }
+
+    return false;
+}
+
+static void wait_open() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(circuit_breaker::open_ms + 10));
+}
+
+COLLECTION(CircuitBreakerSuite)
+    IT("opens after failure_threshold consecutive failures", {
+        fail(1);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::closed).toBeTrue();
+
+        fail(1);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::open).toBeTrue();
+        Expect(rejected()).toBeTrue();
+    })
+
+    IT("starts counting again after a success", {
+        fail(1);
+
+        circuit_breaker::allow(origin).record(true);
+
+        fail(1);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::closed).toBeTrue();
+    })
+
+    IT("goes from closed to open to half-open and back to closed", {
+        fail(2);
+        wait_open();
+
+        auto trial = circuit_breaker::allow(origin);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::half_open).toBeTrue();
+        Expect(rejected()).toBeTrue();
+
+        trial.record(true);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::closed).toBeTrue();
+        Expect(rejected()).toBeFalse();
+    })
+
+    IT("opens again when the trial request fails", {
+        fail(2);
+        wait_open();
+
+        circuit_breaker::allow(origin).record(false);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::open).toBeTrue();
+        Expect(rejected()).toBeTrue();
+    })
+
+    IT("hands an abandoned trial permit to the next request", {
+        fail(2);
+        wait_open();
+
+        {
+            auto trial = circuit_breaker::allow(origin);
+        }
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::open).toBeTrue();
+
+        auto next = circuit_breaker::allow(origin);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::half_open).toBeTrue();
+
+        next.record(true);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::closed).toBeTrue();
+    })
+
+    IT("shares circuits between processes through directory", {
+        circuit_breaker::directory = CircuitBreakerSuite::directory();
+
+        pid_t child = fork();
+
+        if (child == 0) {
+            fail(2);
+
+            _exit(0);
+        }
+
+        waitpid(child, nullptr, 0);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::open).toBeTrue();
+        Expect(rejected()).toBeTrue();
+
+        circuit_breaker::reset();
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::closed).toBeTrue();
+    })
+
+    IT("lets another trial through once a process holding one has died", {
+        circuit_breaker::directory = CircuitBreakerSuite::directory();
+
+        fail(2);
+        wait_open();
+
+        pid_t child = fork();
+
+        if (child == 0) {
+            auto trial = circuit_breaker::allow(origin);
+
+            // Exits without the permit reporting back or being released.
+            _exit(0);
+        }
+
+        waitpid(child, nullptr, 0);
+
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::half_open).toBeTrue();
+        Expect(rejected()).toBeTrue();
+
+        wait_open();
+
+        Expect(rejected()).toBeFalse();
+        Expect(circuit_breaker::get_state(origin) == circuit_breaker::closed).toBeTrue();
+    })
+END()
@@ -0,0 +1,107 @@
+#include "Test.hpp"
+
+SOURCE("app/services/database/Columnar.cpp")
+
+#include "../services/database/Columnar.hpp"
+
+class ColumnarSuite : public TestSuite { };
+
+static serialized integer(long long value)     { return { .type = serialized::integer,        .value = value }; }
+static serialized real(long double value)      { return { .type = serialized::floating_point, .value = value }; }
+static serialized text(std::string value)      { return { .type = serialized::string,         .value = value }; }
+static serialized null()                       { return { .type = serialized::null,           .value = nullptr }; }
+
+static db::column_set orders() {
+    db::column_set set({ "customer", "total" });
+
+    set.push_row(std::vector<serialized> { text("ada"),   integer(10) });
+    set.push_row(std::vector<serialized> { text("grace"), integer(5)  });
+    set.push_row(std::vector<serialized> { text("ada"),   null()      });
+    set.push_row(std::vector<serialized> { null(),        integer(1)  });
+
+    return set;
+}
+
+COLLECTION(ColumnarSuite)
+    IT("stores each column as a typed array", {
+        auto set = orders();
+
+        Expect(set.size()).toBe((size_t)4);
+        Expect(set.column_count()).toBe((size_t)2);
+        Expect((int)set["total"].get_type()).toBe((int)db::column::integer);
+        Expect((int)set["customer"].get_type()).toBe((int)db::column::string);
+        Expect(set["total"].integer_values().size()).toBe((size_t)4);
+    })
+
+    IT("tracks nulls and leaves them out of the aggregates", {
+        auto set = orders();
+
+        Expect(set["total"].is_null(2)).toBeTrue();
+        Expect(set["total"].null_count()).toBe((size_t)1);
+        Expect(set.sum("total")).toBe(16.0);
+        Expect(*set.min("total")).toBe(1.0);
+        Expect(*set.max("total")).toBe(10.0);
+    })
+
+    IT("has no minimum or maximum for a column of nulls", {
+        db::column_set set({ "value" });
+
+        set.push_row(std::vector<serialized> { null() });
+
+        Expect(set.min("value").has_value()).toBeFalse();
+        Expect(set.max("value").has_value()).toBeFalse();
+    })
+
+    IT("widens an integer column receiving a floating point value", {
+        db::column_set set({ "value" });
+
+        set.push_row(std::vector<serialized> { integer(1)  });
+        set.push_row(std::vector<serialized> { real(0.5)   });
+
+        Expect((int)set["value"].get_type()).toBe((int)db::column::floating_point);
+        Expect(set.sum("value")).toBe(1.5);
+    })
+
+    IT("rejects values of another type and rows of the wrong size", {
+        db::column_set set({ "value" });
+
+        set.push_row(std::vector<serialized> { integer(1) });
+
+        bool mismatched = false;
+        bool misshapen  = false;
+
+        try {
+            set.push_row(std::vector<serialized> { text("x") });
+        } catch (std::runtime_error& e) {
+            mismatched = true;
+        }
+
+        try {
+            set.push_row(std::vector<serialized> { integer(1), integer(2) });
+        } catch (std::runtime_error& e) {
+            misshapen = true;
+        }
+
+        Expect(mismatched).toBeTrue();
+        Expect(misshapen).toBeTrue();
+    })
+
+    IT("groups by a key column", {
+        auto groups = orders().group_by("customer", "total");
+
+        Expect(groups.size()).toBe((size_t)3);
+        Expect(groups[std::string("ada")].count).toBe((size_t)1);
+        Expect(groups[std::string("ada")].sum).toBe(10.0);
+        Expect(groups[std::string("grace")].sum).toBe(5.0);
+        Expect(groups[std::nullopt].sum).toBe(1.0);
+    })
+
+    IT("writes the rows as JSON", {
+        db::column_set set({ "name", "score" });
+
+        set.push_row(std::vector<serialized> { text("a\"b"), null()     });
+        set.push_row(std::vector<serialized> { text("c"),    integer(2) });
+
+        Expect(set.to_json()).toBe(std::string("[ { \"name\": \"a\\\"b\", \"score\": null }, { \"name\": \"c\", \"score\": 2 } ]"));
+    })
+END()
@@ -0,0 +1,147 @@
+#include "Test.hpp"
+
+SOURCE("app/services/sqlite/Connection.cpp")
+SOURCE("app/services/sqlite/Model.cpp")
+SOURCE("app/services/sqlite/Statement.cpp")
+SOURCE("app/services/sqlite/Transaction.cpp")
+SOURCE("app/services/database/Columnar.cpp")
+SOURCE("app/services/database/Cursor.cpp")
+SOURCE("app/services/database/Relation.cpp")
+SOURCE("app/services/database/Table.cpp")
+SOURCE("app/services/serialization/Model.cpp")
+LIBRARY("sqlite3")
+
+#include "../services/sqlite/SQLite.hpp"
+
+struct entry : sqlite::model {
+    property<std::string> name { this, "name" };
+    property<long long>   rank { this, "rank" };
+
+    std::string table_name() const { return "cursor_entries"; }
+};
+
+// Concatenates the names of every page, starting with first.
+static std::string read_pages(db::page first) {
+    std::string names;
+
+    while (true) {
+        for (auto& m : first.models) {
+            names += (const std::string&)std::static_pointer_cast<entry>(m)->name;
+        }
+
+        if (first.next.empty()) {
+            return names;
+        }
+
+        first = sqlite::table<entry>().after(first.next).limit(2).paginate();
+    }
+}
+
+class CursorSuite : public TestSuite {
+public:
+    void setup() override {
+        sqlite::connection::set_path(":memory:");
+
+        sqlite::table<entry> entries;
+
+        entries.destroy();
+        entries.create();
+
+        // Ranks repeat across page boundaries when paging two at a time.
+        for (auto [name, rank] : std::vector<std::pair<const char*, long long>> { { "a", 1 }, { "b", 2 }, { "c", 2 }, { "d", 2 }, { "e", 3 } }) {
+            entry e;
+
+            e.name = name;
+            e.rank = rank;
+            e.save();
+        }
+    }
+
+    void beforeEach() override {
+        db::cursor::secret = "test secret";
+    }
+};
+
+COLLECTION(CursorSuite)
+    IT("decodes the key, value, id and direction it encoded", {
+        entry e;
+
+        e.name = "O'Brien";
+        e.id   = 42;
+
+        auto c = db::cursor::decode(db::cursor::encode(e, "name", false));
+
+        Expect(c.key).toBe(std::string("name"));
+        Expect(c.value).toBe(db::to_query_value(std::string("O'Brien")));
+        Expect(c.id).toBe(std::string("42"));
+        Expect(c.asc).toBeFalse();
+    })
+
+    IT("pages through a table", {
+        Expect(read_pages(sqlite::table<entry>().order_by("id").limit(2).paginate())).toBe(std::string("abcde"));
+    })
+
+    IT("keeps rows sharing a key that straddles a page", {
+        Expect(read_pages(sqlite::table<entry>().order_by("rank").limit(2).paginate())).toBe(std::string("abcde"));
+    })
+
+    IT("keeps rows sharing a key when paging backwards", {
+        Expect(read_pages(sqlite::table<entry>().order_by("rank", false).limit(2).paginate())).toBe(std::string("edcba"));
+    })
+
+    IT("rejects a token that was tampered with", {
+        entry e;
+
+        e.name = "a";
+
+        auto token = db::cursor::encode(e, "name", true);
+
+        token[token.size() / 2] = token[token.size() / 2] == 'A' ? 'B' : 'A';
+
+        bool rejected = false;
+
+        try {
+            db::cursor::decode(token);
+        } catch (std::invalid_argument& e) {
+            rejected = true;
+        }
+
+        Expect(rejected).toBeTrue();
+    })
+
+    IT("rejects a token signed with another secret", {
+        entry e;
+
+        e.name = "a";
+
+        auto token = db::cursor::encode(e, "name", true);
+
+        db::cursor::secret = "another secret";
+
+        bool rejected = false;
+
+        try {
+            db::cursor::decode(token);
+        } catch (std::invalid_argument& e) {
+            rejected = true;
+        }
+
+        Expect(rejected).toBeTrue();
+    })
+
+    IT("refuses to encode without a secret", {
+        entry e;
+
+        db::cursor::secret.clear();
+
+        bool refused = false;
+
+        try {
+            db::cursor::encode(e, "name", true);
+        } catch (std::logic_error& e) {
+            refused = true;
+        }
+
+        Expect(refused).toBeTrue();
+    })
+END()
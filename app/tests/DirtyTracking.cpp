@@ -0,0 +1,95 @@
+#include "Test.hpp"
+
+SOURCE("app/services/sqlite/Connection.cpp")
+SOURCE("app/services/sqlite/Model.cpp")
+SOURCE("app/services/sqlite/Statement.cpp")
+SOURCE("app/services/sqlite/Transaction.cpp")
+SOURCE("app/services/database/Columnar.cpp")
+SOURCE("app/services/database/Relation.cpp")
+SOURCE("app/services/database/Table.cpp")
+SOURCE("app/services/serialization/Model.cpp")
+LIBRARY("sqlite3")
+
+#include "../services/sqlite/SQLite.hpp"
+
+struct tracked_user : sqlite::model {
+    property<std::string> name { this, "name" };
+    property<long long>   age  { this, "age"  };
+
+    std::string table_name() const { return "tracked_users"; }
+};
+
+class DirtyTrackingSuite : public TestSuite {
+public:
+    void setup() override {
+        sqlite::connection::set_path(":memory:");
+    }
+
+    void beforeEach() override {
+        sqlite::table<tracked_user> users;
+
+        users.destroy();
+        users.create();
+    }
+};
+
+static std::shared_ptr<tracked_user> find_user(const std::string& name) {
+    auto users = sqlite::table<tracked_user>().where("name", name, "=").get();
+
+    return users.empty() ? nullptr : std::dynamic_pointer_cast<tracked_user>(users.front());
+}
+
+COLLECTION(DirtyTrackingSuite)
+    IT("marks a property dirty when another property is assigned to it", {
+        tracked_user a, b;
+
+        b.name = "Ada";
+        b.mark_clean();
+
+        a.name = b.name;
+
+        Expect(a.name.is_dirty()).toBeTrue();
+        Expect((const std::string&)a.name).toBe(std::string("Ada"));
+    })
+
+    IT("marks a property dirty when it is changed in place", {
+        tracked_user u;
+
+        u.mark_clean();
+        u.name.modify() += "x";
+
+        Expect(u.is_dirty()).toBeTrue();
+    })
+
+    IT("updates a fetched model instead of inserting it again", {
+        tracked_user u;
+
+        u.name = "Ada";
+        u.age  = 36;
+        u.save();
+
+        auto fetched = find_user("Ada");
+
+        Expect(fetched != nullptr).toBeTrue();
+        Expect(fetched->is_dirty()).toBeFalse();
+
+        fetched->age = 37;
+        fetched->save();
+
+        auto all = sqlite::table<tracked_user>().all();
+
+        Expect(all.size()).toBe((size_t)1);
+        Expect((long long)find_user("Ada")->age).toBe(37LL);
+    })
+
+    IT("removes a fetched model", {
+        tracked_user u;
+
+        u.name = "Grace";
+        u.save();
+
+        find_user("Grace")->remove();
+
+        Expect(sqlite::table<tracked_user>().all().size()).toBe((size_t)0);
+    })
+END()
@@ -0,0 +1,91 @@
+#include "Test.hpp"
+
+SOURCE("app/services/mysql/Connection.cpp")
+SOURCE("app/services/mysql/QueryCache.cpp")
+SOURCE("app/services/mysql/Transaction.cpp")
+LIBRARY("mysqlcppconn8")
+
+#include "../services/mysql/QueryCache.hpp"
+
+// Only exercises the parts of the cache that don't reach the server: keys, lookups and eviction.
+class QueryCacheSuite : public TestSuite {
+public:
+    void afterEach() override {
+        mysql::query_cache::disable("cached");
+    }
+};
+
+static db::where_query_t condition(std::string key, std::string value) {
+    return { .key = key, .value = value, .query_operator = "=" };
+}
+
+static std::string key(std::vector<db::where_query_t> wheres, size_t limit = -1, std::vector<std::string> columns = { }) {
+    return mysql::query_cache::key(wheres, { }, limit, 0, columns);
+}
+
+static void store(const std::string& key) {
+    size_t generation = 0;
+
+    mysql::query_cache::find("cached", key, generation);
+    mysql::query_cache::store("cached", key, generation, { });
+}
+
+static bool cached(const std::string& key) {
+    size_t generation = 0;
+
+    return mysql::query_cache::find("cached", key, generation).has_value();
+}
+
+COLLECTION(QueryCacheSuite)
+    IT("keys queries regardless of the order of their conditions", {
+        Expect(key({ condition("a", "1"), condition("b", "2") })).toBe(key({ condition("b", "2"), condition("a", "1") }));
+    })
+
+    IT("keys queries by their conditions, limit and columns", {
+        auto base = key({ condition("a", "1") });
+
+        Expect(key({ condition("a", "2") })).toNotBe(base);
+        Expect(key({ condition("a", "1") }, 10)).toNotBe(base);
+        Expect(key({ condition("a", "1") }, -1, { "id" })).toNotBe(base);
+    })
+
+    IT("only caches tables it was enabled for", {
+        Expect(mysql::query_cache::is_enabled("cached")).toBeFalse();
+
+        store("k");
+
+        Expect(cached("k")).toBeFalse();
+
+        mysql::query_cache::enable("cached", std::chrono::minutes(1));
+        store("k");
+
+        Expect(mysql::query_cache::is_enabled("cached")).toBeTrue();
+        Expect(cached("k")).toBeTrue();
+    })
+
+    IT("evicts the least recently used entry when full", {
+        mysql::query_cache::enable("cached", std::chrono::minutes(1), 2);
+
+        store("a");
+        store("b");
+
+        Expect(cached("a")).toBeTrue();
+
+        store("c");
+
+        Expect(cached("a")).toBeTrue();
+        Expect(cached("b")).toBeFalse();
+        Expect(cached("c")).toBeTrue();
+    })
+
+    IT("does not store results fetched before a newer generation", {
+        mysql::query_cache::enable("cached", std::chrono::minutes(1));
+
+        size_t generation = 0;
+
+        mysql::query_cache::find("cached", "k", generation);
+        mysql::query_cache::store("cached", "k", generation + 1, { });
+
+        Expect(cached("k")).toBeFalse();
+    })
+END()
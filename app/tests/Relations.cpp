@@ -0,0 +1,108 @@
+#include "Test.hpp"
+
+SOURCE("app/services/sqlite/Connection.cpp")
+SOURCE("app/services/sqlite/Model.cpp")
+SOURCE("app/services/sqlite/Statement.cpp")
+SOURCE("app/services/sqlite/Transaction.cpp")
+SOURCE("app/services/database/Columnar.cpp")
+SOURCE("app/services/database/Relation.cpp")
+SOURCE("app/services/database/Table.cpp")
+SOURCE("app/services/serialization/Model.cpp")
+LIBRARY("sqlite3")
+
+#include "../services/sqlite/SQLite.hpp"
+
+struct comment : sqlite::model {
+    property<long long>   post_id { this, "post_id" };
+    property<std::string> body    { this, "body"    };
+
+    std::string table_name() const { return "relation_comments"; }
+};
+
+// Loads relations one key per query, to exercise the batching of eager loads.
+struct comments_one_by_one : sqlite::table<comment> {
+    comments_one_by_one() { batch_size = 1; }
+};
+
+struct post : sqlite::model {
+    property<std::string> title { this, "title" };
+
+    db::has_many<sqlite::table<comment>> comments         { this, "comments",         "post_id" };
+    db::has_many<comments_one_by_one>    batched_comments { this, "batched_comments", "post_id" };
+
+    std::string table_name() const { return "relation_posts"; }
+};
+
+class RelationsSuite : public TestSuite {
+public:
+    void setup() override {
+        sqlite::connection::set_path(":memory:");
+
+        sqlite::table<post>    posts;
+        sqlite::table<comment> comments;
+
+        posts.create();
+        comments.create();
+
+        for (auto title : { "first", "second" }) {
+            post p;
+
+            p.title = title;
+            p.save();
+
+            for (int i = 0; i < 2; i++) {
+                comment c;
+
+                c.post_id = (long long)(size_t)p.id;
+                c.body    = std::string(title) + " " + std::to_string(i);
+                c.save();
+            }
+        }
+    }
+};
+
+COLLECTION(RelationsSuite)
+    IT("eager loads a relation for every model of a result", {
+        auto posts = sqlite::table<post>().with("comments").get();
+
+        Expect(posts.size()).toBe((size_t)2);
+
+        for (auto& m : posts) {
+            auto p = std::static_pointer_cast<post>(m);
+
+            Expect(p->comments.is_loaded()).toBeTrue();
+            Expect(p->comments.get().size()).toBe((size_t)2);
+        }
+    })
+
+    IT("eager loads in batches of batch_size keys", {
+        auto posts = sqlite::table<post>().with("batched_comments").order_by("id").get();
+
+        Expect(posts.size()).toBe((size_t)2);
+
+        for (auto& m : posts) {
+            auto p = std::static_pointer_cast<post>(m);
+
+            Expect(p->batched_comments.get().size()).toBe((size_t)2);
+            Expect((const std::string&)p->batched_comments.get().front()->body).toBe((const std::string&)p->title + " 0");
+        }
+    })
+
+    IT("finds the relations of a copied model", {
+        auto fetched = sqlite::table<post>().order_by("id").get();
+
+        post copy = *std::static_pointer_cast<post>(fetched.front());
+
+        Expect(copy.comments.get().size()).toBe((size_t)2);
+        Expect((const std::string&)copy.comments.get().front()->body).toBe(std::string("first 0"));
+    })
+
+    IT("only lists the selected columns as loaded", {
+        auto selected = sqlite::table<post>().select({ "title" }).get();
+        auto whole    = sqlite::table<post>().all();
+
+        Expect(selected.front()->is_loaded("title")).toBeTrue();
+        Expect(selected.front()->is_loaded("body")).toBeFalse();
+        Expect(whole.front()->is_loaded("body")).toBeTrue();
+    })
+END()
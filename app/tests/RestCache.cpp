@@ -0,0 +1,94 @@
+#include "Test.hpp"
+
+SOURCE("app/services/rest/Batch.cpp")
+SOURCE("app/services/rest/Cache.cpp")
+SOURCE("app/services/rest/Handle.cpp")
+SOURCE("app/services/rest/Resilience.cpp")
+SOURCE("app/services/rest/Rest.cpp")
+SOURCE("app/services/rest/Source.cpp")
+SOURCE("app/services/serialization/Json.cpp")
+SOURCE("app/services/serialization/Model.cpp")
+LIBRARY("curl")
+LIBRARY("z")
+
+#include "../services/rest/Cache.hpp"
+
+// Only exercises which responses are stored and for how long, which doesn't reach an upstream.
+class RestCacheSuite : public TestSuite { };
+
+static std::optional<rest::cache::entry> entry(std::map<std::string, std::string> headers, std::vector<rest::header> request_headers = { }) {
+    rest::request  r   { .u = std::string("https://upstream.test/countries"), .headers = request_headers };
+    rest::response res { .status_code = 200, .data = "[]", .headers = headers };
+
+    return rest::cache::make_entry(r, res);
+}
+
+// Seconds until the entry expires, rounded to the nearest second.
+static long fresh_for(const rest::cache::entry& e) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(e.expires - rest::cache::clock::now());
+
+    return (left.count() + 500) / 1000;
+}
+
+COLLECTION(RestCacheSuite)
+    IT("keeps a response for its max-age", {
+        auto e = entry({ { "cache-control", "public, max-age=60" } });
+
+        Expect(e.has_value()).toBeTrue();
+        Expect(fresh_for(*e)).toBe(60L);
+    })
+
+    IT("subtracts the Age the response already spent in other caches", {
+        auto e = entry({ { "cache-control", "max-age=60" }, { "age", "45" } });
+
+        Expect(fresh_for(*e)).toBe(15L);
+        Expect(fresh_for(*entry({ { "cache-control", "max-age=60" }, { "age", "90" } }))).toBe(0L);
+    })
+
+    IT("prefers s-maxage over max-age", {
+        auto e = entry({ { "cache-control", "max-age=60, s-maxage=\"10\"" } });
+
+        Expect(fresh_for(*e)).toBe(10L);
+    })
+
+    IT("revalidates no-cache responses before every use", {
+        auto e = entry({ { "cache-control", "no-cache, max-age=60" }, { "etag", "\"v1\"" } });
+
+        Expect(e.has_value()).toBeTrue();
+        Expect(fresh_for(*e)).toBe(0L);
+        Expect(e->etag).toBe(std::string("\"v1\""));
+    })
+
+    IT("doesn't store no-store or private responses", {
+        Expect(entry({ { "cache-control", "no-store" } }).has_value()).toBeFalse();
+        Expect(entry({ { "cache-control", "Private, max-age=60" } }).has_value()).toBeFalse();
+    })
+
+    IT("doesn't store responses it could never reuse", {
+        Expect(entry({ }).has_value()).toBeFalse();
+        Expect(entry({ { "etag", "\"v1\"" } }).has_value()).toBeTrue();
+
+        rest::response missing { .status_code = 404, .headers = { { "cache-control", "max-age=60" } } };
+
+        Expect(rest::cache::make_entry({ .u = std::string("https://upstream.test/missing") }, missing).has_value()).toBeFalse();
+    })
+
+    IT("only stores responses to requests with credentials when marked shared", {
+        Expect(entry({ { "cache-control", "max-age=60" } }, { "Authorization: Bearer a" }).has_value()).toBeFalse();
+        Expect(entry({ { "cache-control", "max-age=60" } }, { "Cookie: session=a" }).has_value()).toBeFalse();
+        Expect(entry({ { "cache-control", "public, max-age=60" } }, { "Authorization: Bearer a" }).has_value()).toBeTrue();
+        Expect(entry({ { "cache-control", "s-maxage=60" } }, { "Cookie: session=a" }).has_value()).toBeTrue();
+    })
+
+    IT("records the request headers named by Vary", {
+        auto e = entry({ { "cache-control", "max-age=60" }, { "vary", "Accept-Language, Accept" } }, { "accept-language: de", "X-Other: 1" });
+
+        Expect(e->vary.size()).toBe((size_t)2);
+        Expect(e->vary[0]).toBe(std::string("accept-language: de"));
+        Expect(e->vary[1]).toBe(std::string("accept: "));
+    })
+
+    IT("doesn't store responses varying on everything", {
+        Expect(entry({ { "cache-control", "max-age=60" }, { "vary", "*" } }).has_value()).toBeFalse();
+    })
+END()
@@ -0,0 +1,165 @@
+#include "Test.hpp"
+
+SOURCE("app/services/sqlite/Connection.cpp")
+SOURCE("app/services/sqlite/Model.cpp")
+SOURCE("app/services/sqlite/Statement.cpp")
+SOURCE("app/services/sqlite/Transaction.cpp")
+SOURCE("app/services/database/Columnar.cpp")
+SOURCE("app/services/database/Relation.cpp")
+SOURCE("app/services/database/Table.cpp")
+SOURCE("app/services/serialization/Model.cpp")
+LIBRARY("sqlite3")
+
+#include "../services/sqlite/SQLite.hpp"
+
+struct book : sqlite::model {
+    property<std::string> title { this, "title" };
+    property<long long>   pages { this, "pages" };
+
+    std::string table_name() const { return "books"; }
+};
+
+class SQLiteSuite : public TestSuite {
+public:
+    void setup() override {
+        sqlite::connection::set_path(":memory:");
+    }
+
+    void beforeEach() override {
+        sqlite::table<book> books;
+
+        books.destroy();
+        books.create();
+    }
+};
+
+static std::shared_ptr<book> make_book(const std::string& title, long long pages) {
+    auto b = std::make_shared<book>();
+
+    b->title = title;
+    b->pages = pages;
+
+    return b;
+}
+
+static size_t count_books() {
+    return sqlite::table<book>().all().size();
+}
+
+static long long pages_of(const std::string& title) {
+    auto found = sqlite::table<book>().where("title", title, "=").get();
+
+    return found.empty() ? -1 : (long long)std::static_pointer_cast<book>(found.front())->pages;
+}
+
+COLLECTION(SQLiteSuite)
+    IT("saves, fetches, updates and removes a model", {
+        auto b = make_book("Dune", 412);
+
+        b->save();
+
+        Expect((size_t)b->id).toBeGreaterThan((size_t)0);
+        Expect(pages_of("Dune")).toBe(412LL);
+
+        b->pages = 500;
+        b->save();
+
+        Expect(count_books()).toBe((size_t)1);
+        Expect(pages_of("Dune")).toBe(500LL);
+
+        b->remove();
+
+        Expect(count_books()).toBe((size_t)0);
+    })
+
+    IT("inserts, updates and upserts in batches", {
+        sqlite::table<book> books;
+
+        std::vector<std::shared_ptr<db::model>> models;
+
+        for (long long i = 0; i < 10; i++) {
+            models.push_back(make_book("Book " + std::to_string(i), i));
+        }
+
+        books.insert(models);
+
+        Expect(count_books()).toBe((size_t)10);
+
+        for (auto& m : models) {
+            std::static_pointer_cast<book>(m)->pages += 100;
+        }
+
+        books.update(models);
+
+        Expect(pages_of("Book 3")).toBe(103LL);
+
+        std::static_pointer_cast<book>(models[0])->pages = 7;
+        models.push_back(make_book("Book 10", 10));
+
+        books.upsert(models);
+
+        Expect(count_books()).toBe((size_t)11);
+        Expect(pages_of("Book 0")).toBe(7LL);
+        Expect(pages_of("Book 10")).toBe(10LL);
+    })
+
+    IT("rolls back a savepoint without the enclosing transaction", {
+        auto& conn = sqlite::connection::get_instance();
+
+        {
+            auto outer = conn.begin();
+
+            make_book("Kept", 1)->save();
+
+            {
+                auto inner = conn.begin();
+
+                make_book("Dropped", 2)->save();
+
+                inner.rollback();
+            }
+
+            Expect(conn.in_transaction()).toBeTrue();
+
+            outer.commit();
+        }
+
+        Expect(conn.in_transaction()).toBeFalse();
+        Expect(pages_of("Kept")).toBe(1LL);
+        Expect(pages_of("Dropped")).toBe(-1LL);
+    })
+
+    IT("rolls back a transaction left unfinished", {
+        auto& conn = sqlite::connection::get_instance();
+
+        {
+            auto t = conn.begin();
+
+            make_book("Lost", 1)->save();
+        }
+
+        Expect(count_books()).toBe((size_t)0);
+    })
+
+    IT("removes models in bulk", {
+        sqlite::table<book> books;
+
+        std::vector<std::shared_ptr<db::model>> models;
+
+        for (long long i = 0; i < 20; i++) {
+            models.push_back(make_book("Book " + std::to_string(i), i));
+        }
+
+        books.insert(models);
+
+        books.batch_size = 3;
+        books.remove(std::vector<std::shared_ptr<db::model>>(models.begin(), models.begin() + 5));
+
+        Expect(count_books()).toBe((size_t)15);
+
+        Expect(sqlite::table<book>().where("pages", 10, "<").remove()).toBe((size_t)5);
+        Expect(sqlite::table<book>().order_by("pages").limit(4).remove()).toBe((size_t)4);
+        Expect(pages_of("Book 14")).toBe(14LL);
+        Expect(count_books()).toBe((size_t)6);
+    })
+END()
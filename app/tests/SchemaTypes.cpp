@@ -0,0 +1,42 @@
+#include "Test.hpp"
+
+SOURCE("app/services/mysql/Connection.cpp")
+SOURCE("app/services/mysql/QueryCache.cpp")
+SOURCE("app/services/mysql/Schema.cpp")
+SOURCE("app/services/mysql/Transaction.cpp")
+LIBRARY("mysqlcppconn8")
+
+#include "../services/mysql/Schema.hpp"
+
+class SchemaTypesSuite : public TestSuite { };
+
+static std::string normalize(const std::string& type) {
+    return mysql::migration::normalize_type(type);
+}
+
+COLLECTION(SchemaTypesSuite)
+    IT("drops the display width of integer types", {
+        Expect(normalize("INT(11)")).toBe(std::string("int"));
+        Expect(normalize("bigint(20) unsigned")).toBe(std::string("bigint unsigned"));
+        Expect(normalize("int")).toBe(normalize("int(10)"));
+    })
+
+    IT("keeps tinyint(1), which booleans are stored as", {
+        Expect(normalize("tinyint(1)")).toBe(std::string("tinyint(1)"));
+        Expect(normalize("tinyint(4)")).toBe(std::string("tinyint"));
+    })
+
+    IT("resolves aliases", {
+        Expect(normalize("integer")).toBe(std::string("int"));
+        Expect(normalize("BOOL")).toBe(std::string("tinyint(1)"));
+        Expect(normalize("boolean")).toBe(std::string("tinyint(1)"));
+        Expect(normalize("numeric(8, 2)")).toBe(std::string("decimal(8,2)"));
+        Expect(normalize("decimal")).toBe(std::string("decimal(10,0)"));
+        Expect(normalize("double precision")).toBe(std::string("double"));
+    })
+
+    IT("leaves the length of string types alone", {
+        Expect(normalize("VARCHAR(64)")).toBe(std::string("varchar(64)"));
+        Expect(normalize("varchar(64)") == normalize("varchar(128)")).toBeFalse();
+    })
+END()
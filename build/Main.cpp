@@ -275,8 +275,10 @@ int main()
     index->addLibrary("cgicc");
     index->addLibrary("png");
     index->addLibrary("curl");
+    index->addLibrary("z");
     index->addLibrary("mysqlcppconn");
     index->addLibrary("mysqlcppconn8");
+    index->addLibrary("sqlite3");
     index->addLibrary("stdc++exp");
 
     // Create build manager